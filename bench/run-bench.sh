@@ -0,0 +1,61 @@
+#!/bin/sh
+#
+# Runs xfwm4-bench against xfwm4 on a private Xvfb server and prints
+# the JSON report on stdout.
+#
+#   run-bench.sh <xfwm4-bench> <xfwm4> [xfwm4-bench options]
+#
+# Xvfb, and dbus-run-session (or dbus-launch) for xfconf, are taken
+# from $PATH. BENCH_WINDOWS and BENCH_ROUNDS override the defaults.
+
+if test $# -lt 2; then
+    echo "usage: $0 <xfwm4-bench> <xfwm4> [options]" >&2
+    exit 2
+fi
+BENCH=$1
+XFWM4=$2
+shift 2
+
+if ! command -v Xvfb >/dev/null 2>&1; then
+    echo "$0: Xvfb not found" >&2
+    exit 1
+fi
+
+# Keep the user's settings and caches out of the measurements
+BENCH_HOME=`mktemp -d "${TMPDIR:-/tmp}/xfwm4-bench.XXXXXX"` || exit 1
+XDG_CONFIG_HOME="$BENCH_HOME/config"
+XDG_CACHE_HOME="$BENCH_HOME/cache"
+export XDG_CONFIG_HOME XDG_CACHE_HOME
+
+display=90
+while test -e "/tmp/.X$display-lock" || test -e "/tmp/.X11-unix/X$display"; do
+    display=`expr $display + 1`
+done
+
+Xvfb ":$display" -screen 0 1280x1024x24 -nolisten tcp \
+     +extension Composite +extension RENDER +extension XTEST >/dev/null 2>&1 &
+xvfb_pid=$!
+trap 'kill $xvfb_pid 2>/dev/null; rm -rf "$BENCH_HOME"' EXIT INT TERM
+
+tries=0
+while ! test -e "/tmp/.X11-unix/X$display"; do
+    tries=`expr $tries + 1`
+    if test $tries -gt 100 || ! kill -0 $xvfb_pid 2>/dev/null; then
+        echo "$0: Xvfb did not start" >&2
+        exit 1
+    fi
+    sleep 0.1
+done
+DISPLAY=":$display"
+export DISPLAY
+
+if command -v dbus-run-session >/dev/null 2>&1; then
+    session="dbus-run-session --"
+elif command -v dbus-launch >/dev/null 2>&1; then
+    session="dbus-launch --exit-with-session"
+else
+    session=""
+fi
+
+$session "$BENCH" -n "${BENCH_WINDOWS:-100}" -r "${BENCH_ROUNDS:-20}" "$@" \
+    -- "$XFWM4" --compositor=on --replace
@@ -0,0 +1,771 @@
+/*      $Id$
+
+        This program is free software; you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation; either version 2, or (at your option)
+        any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program; if not, write to the Free Software
+        Foundation, Inc., Inc., 51 Franklin Street, Fifth Floor, Boston,
+        MA 02110-1301, USA.
+
+
+        xfwm4    - (c) 2002-2011 Olivier Fourdan
+
+ */
+
+/*
+ * Scripted client for "make bench".
+ *
+ * Maps N windows on a bare display, starts the window manager given on
+ * the command line, and times how it adopts them, maps new windows,
+ * raises on click, switches workspaces and follows a drag. The pointer
+ * is driven through XTest. The report is printed on stdout as JSON and
+ * embeds the XFWM4_STATS property published by xfwm4, which carries the
+ * compositor frame times.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/XTest.h>
+#include <sys/select.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_WINDOWS         100
+#define DEFAULT_ROUNDS          20
+#define WINDOW_WIDTH            300
+#define WINDOW_HEIGHT           200
+#define DRAG_STEPS              200
+#define DRAG_STEP_SIZE          2
+#define ADOPT_TIMEOUT           30000000 /* us */
+#define EVENT_TIMEOUT           5000000  /* us */
+#define SETTLE_DELAY            500000   /* us */
+#define STATS_DELAY             1500000  /* us */
+
+typedef long long Usec;
+
+typedef struct _Bench Bench;
+struct _Bench
+{
+    Display *dpy;
+    int screen;
+    Window root;
+    Window wm_win;
+    Atom wm_sn;
+    Atom net_current_desktop;
+    Atom net_number_of_desktops;
+    Atom xfwm4_stats;
+    Atom utf8_string;
+    Window *windows;
+    int count;
+    pid_t wm_pid;
+    Bool have_xtest;
+};
+
+typedef struct _Samples Samples;
+struct _Samples
+{
+    int count;
+    Usec total;
+    Usec min;
+    Usec max;
+};
+
+typedef Bool (*EventFunc) (Bench *, XEvent *, void *);
+
+static Usec
+now_us (void)
+{
+    struct timespec ts;
+
+    clock_gettime (CLOCK_MONOTONIC, &ts);
+    return (Usec) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void
+samples_add (Samples *samples, Usec value)
+{
+    if ((samples->count == 0) || (value < samples->min))
+    {
+        samples->min = value;
+    }
+    if ((samples->count == 0) || (value > samples->max))
+    {
+        samples->max = value;
+    }
+    samples->total += value;
+    samples->count++;
+}
+
+static void
+samples_print (const char *name, Samples *samples)
+{
+    if (samples->count == 0)
+    {
+        printf ("  \"%s\": null,\n", name);
+        return;
+    }
+    printf ("  \"%s\": {\"samples\": %d, \"mean_us\": %lld, \"min_us\": %lld, \"max_us\": %lld},\n",
+            name, samples->count, samples->total / samples->count, samples->min, samples->max);
+}
+
+/* Dispatches events to func until it returns True, or times out */
+static Bool
+wait_for (Bench *bench, EventFunc func, void *data, Usec timeout)
+{
+    struct timeval tv;
+    fd_set fds;
+    XEvent ev;
+    Usec deadline, left;
+    int fd;
+
+    fd = ConnectionNumber (bench->dpy);
+    deadline = now_us () + timeout;
+    for (;;)
+    {
+        while (XPending (bench->dpy))
+        {
+            XNextEvent (bench->dpy, &ev);
+            if (func (bench, &ev, data))
+            {
+                return True;
+            }
+        }
+        left = deadline - now_us ();
+        if (left <= 0)
+        {
+            return False;
+        }
+        FD_ZERO (&fds);
+        FD_SET (fd, &fds);
+        tv.tv_sec = left / 1000000;
+        tv.tv_usec = left % 1000000;
+        if ((select (fd + 1, &fds, NULL, NULL, &tv) < 0) && (errno != EINTR))
+        {
+            return False;
+        }
+    }
+}
+
+static Bool
+drain_cb (Bench *bench, XEvent *ev, void *data)
+{
+    return False;
+}
+
+/* Lets the window manager settle and drops whatever was queued meanwhile */
+static void
+settle (Bench *bench, Usec delay)
+{
+    XSync (bench->dpy, False);
+    wait_for (bench, drain_cb, NULL, delay);
+}
+
+static Bool
+is_ours (Bench *bench, Window w)
+{
+    int i;
+
+    for (i = 0; i < bench->count; i++)
+    {
+        if (bench->windows[i] == w)
+        {
+            return True;
+        }
+    }
+    return False;
+}
+
+static Window
+create_window (Bench *bench, int x, int y)
+{
+    XSetWindowAttributes attrs;
+    XSizeHints hints;
+    Window w;
+
+    attrs.background_pixel = WhitePixel (bench->dpy, bench->screen);
+    attrs.event_mask = StructureNotifyMask;
+    w = XCreateWindow (bench->dpy, bench->root, x, y, WINDOW_WIDTH, WINDOW_HEIGHT, 0,
+                       CopyFromParent, InputOutput, CopyFromParent,
+                       CWBackPixel | CWEventMask, &attrs);
+    hints.flags = USPosition | USSize;
+    hints.x = x;
+    hints.y = y;
+    hints.width = WINDOW_WIDTH;
+    hints.height = WINDOW_HEIGHT;
+    XSetWMNormalHints (bench->dpy, w, &hints);
+    XStoreName (bench->dpy, w, "xfwm4-bench");
+
+    return w;
+}
+
+static Window
+get_parent (Bench *bench, Window w)
+{
+    Window root, parent, *children;
+    unsigned int n;
+
+    if (!XQueryTree (bench->dpy, w, &root, &parent, &children, &n))
+    {
+        return None;
+    }
+    if (children)
+    {
+        XFree (children);
+    }
+    return parent;
+}
+
+static long
+get_cardinal (Bench *bench, Window w, Atom atom)
+{
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+    Atom type;
+    long value;
+    int format;
+
+    data = NULL;
+    value = -1;
+    if ((XGetWindowProperty (bench->dpy, w, atom, 0, 1, False, XA_CARDINAL,
+                             &type, &format, &nitems, &bytes_after, &data) == Success)
+        && (data) && (nitems == 1) && (format == 32))
+    {
+        value = *((long *) data);
+    }
+    if (data)
+    {
+        XFree (data);
+    }
+    return value;
+}
+
+/*
+ * Adoption of N pre-existing windows: from the exec of the window
+ * manager, and from the moment it owns WM_Sn, until all of them are
+ * reparented into frames.
+ */
+
+typedef struct _AdoptData AdoptData;
+struct _AdoptData
+{
+    int reparented;
+    Usec owner_time;
+};
+
+static Bool
+adopt_cb (Bench *bench, XEvent *ev, void *data)
+{
+    AdoptData *adopt;
+
+    adopt = (AdoptData *) data;
+    /* Reparenting from the root is reported on the root as well, count it once */
+    if ((ev->type == ReparentNotify) && (ev->xreparent.event == ev->xreparent.window)
+        && (ev->xreparent.parent != bench->root) && (is_ours (bench, ev->xreparent.window)))
+    {
+        adopt->reparented++;
+    }
+    if (adopt->owner_time == 0)
+    {
+        bench->wm_win = XGetSelectionOwner (bench->dpy, bench->wm_sn);
+        if (bench->wm_win != None)
+        {
+            adopt->owner_time = now_us ();
+        }
+    }
+    return (adopt->reparented >= bench->count);
+}
+
+static Bool
+bench_adopt (Bench *bench, char **wm_argv, Usec *total, Usec *from_owner)
+{
+    AdoptData adopt;
+    XEvent ev;
+    Usec start;
+    int i;
+
+    for (i = 0; i < bench->count; i++)
+    {
+        bench->windows[i] = create_window (bench, (i * 13) % 800, (i * 17) % 600);
+        XMapWindow (bench->dpy, bench->windows[i]);
+    }
+    XSync (bench->dpy, False);
+    while (XPending (bench->dpy))
+    {
+        XNextEvent (bench->dpy, &ev);
+    }
+
+    start = now_us ();
+    bench->wm_pid = fork ();
+    if (bench->wm_pid < 0)
+    {
+        perror ("fork");
+        return False;
+    }
+    if (bench->wm_pid == 0)
+    {
+        execvp (wm_argv[0], wm_argv);
+        perror (wm_argv[0]);
+        _exit (127);
+    }
+
+    adopt.reparented = 0;
+    adopt.owner_time = 0;
+    ev.type = 0;
+    /* Wake up every millisecond to poll the WM_Sn selection owner */
+    while (!adopt_cb (bench, &ev, &adopt) || (adopt.owner_time == 0))
+    {
+        if (now_us () - start > ADOPT_TIMEOUT)
+        {
+            fprintf (stderr, "xfwm4-bench: %d out of %d windows adopted\n", adopt.reparented, bench->count);
+            return False;
+        }
+        ev.type = 0;
+        if (XPending (bench->dpy))
+        {
+            XNextEvent (bench->dpy, &ev);
+        }
+        else
+        {
+            usleep (1000);
+        }
+    }
+    *total = now_us () - start;
+    *from_owner = now_us () - adopt.owner_time;
+
+    return True;
+}
+
+/* Map-to-frame latency: from XMapWindow until the framed window is mapped */
+
+typedef struct _MapData MapData;
+struct _MapData
+{
+    Window w;
+    int type;
+};
+
+static Bool
+map_cb (Bench *bench, XEvent *ev, void *data)
+{
+    MapData *map;
+
+    map = (MapData *) data;
+    return ((ev->type == map->type) && (ev->xany.window == map->w));
+}
+
+static void
+bench_map (Bench *bench, int rounds, Samples *samples)
+{
+    MapData map;
+    Usec start;
+    int i;
+
+    for (i = 0; i < rounds; i++)
+    {
+        map.w = create_window (bench, 400, 300);
+        map.type = MapNotify;
+        XSync (bench->dpy, False);
+        start = now_us ();
+        XMapWindow (bench->dpy, map.w);
+        XFlush (bench->dpy);
+        if (wait_for (bench, map_cb, &map, EVENT_TIMEOUT))
+        {
+            samples_add (samples, now_us () - start);
+        }
+        XDestroyWindow (bench->dpy, map.w);
+        settle (bench, SETTLE_DELAY / 10);
+    }
+}
+
+/* Focus click to raise latency: from the button press until the frame is restacked */
+
+typedef struct _RaiseData RaiseData;
+struct _RaiseData
+{
+    Window frame;
+};
+
+static Bool
+raise_cb (Bench *bench, XEvent *ev, void *data)
+{
+    RaiseData *raise;
+
+    raise = (RaiseData *) data;
+    return ((ev->type == ConfigureNotify) && (ev->xconfigure.window == raise->frame));
+}
+
+static void
+click (Bench *bench, int x, int y)
+{
+    XTestFakeMotionEvent (bench->dpy, bench->screen, x, y, CurrentTime);
+    XTestFakeButtonEvent (bench->dpy, Button1, True, CurrentTime);
+    XTestFakeButtonEvent (bench->dpy, Button1, False, CurrentTime);
+    XFlush (bench->dpy);
+}
+
+static void
+root_coords (Bench *bench, Window w, int *x, int *y)
+{
+    Window child;
+
+    XTranslateCoordinates (bench->dpy, w, bench->root, 0, 0, x, y, &child);
+}
+
+static void
+bench_raise (Bench *bench, Window a, Window b, int rounds, Samples *samples)
+{
+    RaiseData raise;
+    Usec start;
+    int ax, ay, bx, by;
+    int i;
+
+    root_coords (bench, a, &ax, &ay);
+    root_coords (bench, b, &bx, &by);
+    for (i = 0; i < rounds; i++)
+    {
+        settle (bench, SETTLE_DELAY / 10);
+        start = now_us ();
+        /* b sits below and to the right of a, click the part left uncovered */
+        if (i % 2)
+        {
+            raise.frame = get_parent (bench, b);
+            click (bench, bx + WINDOW_WIDTH - 10, by + WINDOW_HEIGHT - 10);
+        }
+        else
+        {
+            raise.frame = get_parent (bench, a);
+            click (bench, ax + 10, ay + 10);
+        }
+        if (wait_for (bench, raise_cb, &raise, EVENT_TIMEOUT))
+        {
+            samples_add (samples, now_us () - start);
+        }
+    }
+}
+
+/*
+ * Workspace switch time: from the _NET_CURRENT_DESKTOP request until
+ * all our windows are hidden (or shown again) and the root property
+ * is updated.
+ */
+
+typedef struct _SwitchData SwitchData;
+struct _SwitchData
+{
+    int type;
+    int pending;
+    Bool property;
+};
+
+static Bool
+switch_cb (Bench *bench, XEvent *ev, void *data)
+{
+    SwitchData *sw;
+
+    sw = (SwitchData *) data;
+    /* MapNotify and UnmapNotify share their layout, event then window */
+    if ((ev->type == sw->type) && (ev->xunmap.event == ev->xunmap.window) && (is_ours (bench, ev->xunmap.window)))
+    {
+        sw->pending--;
+    }
+    else if ((ev->type == PropertyNotify) && (ev->xproperty.atom == bench->net_current_desktop))
+    {
+        sw->property = True;
+    }
+    return ((sw->pending <= 0) && (sw->property));
+}
+
+static void
+send_root_message (Bench *bench, Atom type, long value)
+{
+    XEvent ev;
+
+    memset (&ev, 0, sizeof (ev));
+    ev.xclient.type = ClientMessage;
+    ev.xclient.window = bench->root;
+    ev.xclient.message_type = type;
+    ev.xclient.format = 32;
+    ev.xclient.data.l[0] = value;
+    ev.xclient.data.l[1] = CurrentTime;
+    XSendEvent (bench->dpy, bench->root, False,
+                SubstructureNotifyMask | SubstructureRedirectMask, &ev);
+    XFlush (bench->dpy);
+}
+
+static void
+bench_switch (Bench *bench, int rounds, Samples *samples)
+{
+    SwitchData sw;
+    Usec start;
+    int i;
+
+    if (get_cardinal (bench, bench->root, bench->net_number_of_desktops) < 2)
+    {
+        send_root_message (bench, bench->net_number_of_desktops, 2);
+    }
+    for (i = 0; i < rounds; i++)
+    {
+        settle (bench, SETTLE_DELAY / 10);
+        sw.type = (i % 2) ? MapNotify : UnmapNotify;
+        sw.pending = bench->count;
+        sw.property = False;
+        start = now_us ();
+        send_root_message (bench, bench->net_current_desktop, (i % 2) ? 0 : 1);
+        if (wait_for (bench, switch_cb, &sw, EVENT_TIMEOUT))
+        {
+            samples_add (samples, now_us () - start);
+        }
+    }
+    if (rounds % 2)
+    {
+        send_root_message (bench, bench->net_current_desktop, 0);
+    }
+}
+
+/* Drag move: frame moves the window manager manages per second of drag */
+
+typedef struct _DragData DragData;
+struct _DragData
+{
+    Window frame;
+    int moves;
+    int last_x;
+};
+
+static Bool
+drag_cb (Bench *bench, XEvent *ev, void *data)
+{
+    DragData *drag;
+
+    drag = (DragData *) data;
+    if ((ev->type == ConfigureNotify) && (ev->xconfigure.window == drag->frame)
+        && (ev->xconfigure.x != drag->last_x))
+    {
+        drag->last_x = ev->xconfigure.x;
+        drag->moves++;
+    }
+    return False;
+}
+
+static void
+bench_drag (Bench *bench, Window w, int *moves, Usec *elapsed)
+{
+    XWindowAttributes attrs;
+    DragData drag;
+    XEvent ev;
+    Usec start;
+    int x, y, cx, cy;
+    int i;
+
+    drag.frame = get_parent (bench, w);
+    drag.moves = 0;
+    root_coords (bench, drag.frame, &x, &y);
+    root_coords (bench, w, &cx, &cy);
+    XGetWindowAttributes (bench->dpy, drag.frame, &attrs);
+    drag.last_x = x;
+    /* Grab the middle of the title bar, between the frame and the client tops */
+    x += attrs.width / 2;
+    y += (cy > y + 1) ? (cy - y) / 2 : 1;
+
+    settle (bench, SETTLE_DELAY / 10);
+    XTestFakeMotionEvent (bench->dpy, bench->screen, x, y, CurrentTime);
+    XTestFakeButtonEvent (bench->dpy, Button1, True, CurrentTime);
+    XSync (bench->dpy, False);
+    start = now_us ();
+    for (i = 1; i <= DRAG_STEPS; i++)
+    {
+        XTestFakeMotionEvent (bench->dpy, bench->screen, x + i * DRAG_STEP_SIZE, y, CurrentTime);
+        XFlush (bench->dpy);
+        while (XPending (bench->dpy))
+        {
+            XNextEvent (bench->dpy, &ev);
+            drag_cb (bench, &ev, &drag);
+        }
+    }
+    XTestFakeButtonEvent (bench->dpy, Button1, False, CurrentTime);
+    XSync (bench->dpy, False);
+    /* Collect the moves still in flight */
+    wait_for (bench, drag_cb, &drag, SETTLE_DELAY / 5);
+    *elapsed = now_us () - start;
+    *moves = drag.moves;
+}
+
+static void
+print_stats (Bench *bench)
+{
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+    Atom type;
+    int format;
+
+    data = NULL;
+    if ((bench->wm_win != None)
+        && (XGetWindowProperty (bench->dpy, bench->wm_win, bench->xfwm4_stats, 0, 65536, False,
+                                bench->utf8_string, &type, &format, &nitems, &bytes_after,
+                                &data) == Success)
+        && (data) && (format == 8) && (nitems > 0))
+    {
+        printf ("  \"xfwm4_stats\": %s\n", (char *) data);
+    }
+    else
+    {
+        printf ("  \"xfwm4_stats\": null\n");
+    }
+    if (data)
+    {
+        XFree (data);
+    }
+}
+
+static void
+usage (const char *name)
+{
+    fprintf (stderr, "usage: %s [-n windows] [-r rounds] -- window-manager [args...]\n", name);
+    exit (2);
+}
+
+int
+main (int argc, char **argv)
+{
+    Bench bench;
+    Samples map, raise, sw;
+    Usec adopt_total, adopt_owner, drag_elapsed;
+    Window a, b;
+    char name[32];
+    int rounds, drag_moves;
+    int event_base, error_base, major, minor;
+    int opt, status;
+
+    memset (&bench, 0, sizeof (bench));
+    bench.count = DEFAULT_WINDOWS;
+    rounds = DEFAULT_ROUNDS;
+    while ((opt = getopt (argc, argv, "n:r:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                bench.count = atoi (optarg);
+                break;
+            case 'r':
+                rounds = atoi (optarg);
+                break;
+            default:
+                usage (argv[0]);
+        }
+    }
+    if ((optind >= argc) || (bench.count < 1) || (rounds < 1))
+    {
+        usage (argv[0]);
+    }
+
+    bench.dpy = XOpenDisplay (NULL);
+    if (!bench.dpy)
+    {
+        fprintf (stderr, "xfwm4-bench: cannot open display\n");
+        return 1;
+    }
+    bench.screen = DefaultScreen (bench.dpy);
+    bench.root = RootWindow (bench.dpy, bench.screen);
+    snprintf (name, sizeof (name), "WM_S%d", bench.screen);
+    bench.wm_sn = XInternAtom (bench.dpy, name, False);
+    bench.net_current_desktop = XInternAtom (bench.dpy, "_NET_CURRENT_DESKTOP", False);
+    bench.net_number_of_desktops = XInternAtom (bench.dpy, "_NET_NUMBER_OF_DESKTOPS", False);
+    bench.xfwm4_stats = XInternAtom (bench.dpy, "XFWM4_STATS", False);
+    bench.utf8_string = XInternAtom (bench.dpy, "UTF8_STRING", False);
+    bench.have_xtest = XTestQueryExtension (bench.dpy, &event_base, &error_base, &major, &minor);
+    if (XGetSelectionOwner (bench.dpy, bench.wm_sn) != None)
+    {
+        fprintf (stderr, "xfwm4-bench: a window manager is already running\n");
+        return 1;
+    }
+    XSelectInput (bench.dpy, bench.root, SubstructureNotifyMask | PropertyChangeMask);
+
+    /* Room for the adopted windows plus the two used for clicks and drags */
+    bench.windows = calloc (bench.count + 2, sizeof (Window));
+    if (!bench_adopt (&bench, argv + optind, &adopt_total, &adopt_owner))
+    {
+        if (bench.wm_pid > 0)
+        {
+            kill (bench.wm_pid, SIGTERM);
+        }
+        return 1;
+    }
+    settle (&bench, SETTLE_DELAY);
+
+    memset (&map, 0, sizeof (map));
+    memset (&raise, 0, sizeof (raise));
+    memset (&sw, 0, sizeof (sw));
+    drag_moves = 0;
+    drag_elapsed = 0;
+
+    bench_map (&bench, rounds, &map);
+
+    a = create_window (&bench, 100, 100);
+    b = create_window (&bench, 200, 150);
+    bench.windows[bench.count++] = a;
+    bench.windows[bench.count++] = b;
+    XMapWindow (bench.dpy, a);
+    XMapWindow (bench.dpy, b);
+    settle (&bench, SETTLE_DELAY);
+
+    if (bench.have_xtest)
+    {
+        bench_raise (&bench, a, b, rounds, &raise);
+    }
+    bench_switch (&bench, rounds, &sw);
+    settle (&bench, SETTLE_DELAY);
+    if (bench.have_xtest)
+    {
+        bench_drag (&bench, a, &drag_moves, &drag_elapsed);
+    }
+    /* xfwm4 publishes its counters at most once per second */
+    settle (&bench, STATS_DELAY);
+
+    printf ("{\n");
+    printf ("  \"windows\": %d,\n", bench.count - 2);
+    printf ("  \"rounds\": %d,\n", rounds);
+    printf ("  \"adopt\": {\"total_us\": %lld, \"from_wm_selection_us\": %lld},\n", adopt_total, adopt_owner);
+    samples_print ("map_to_frame", &map);
+    samples_print ("click_to_raise", &raise);
+    samples_print ("workspace_switch", &sw);
+    if (drag_elapsed > 0)
+    {
+        printf ("  \"drag_move\": {\"motion_events\": %d, \"frame_moves\": %d, \"elapsed_us\": %lld, "
+                "\"moves_per_second\": %.1f},\n",
+                DRAG_STEPS, drag_moves, drag_elapsed, drag_moves * 1000000.0 / drag_elapsed);
+    }
+    else
+    {
+        printf ("  \"drag_move\": null,\n");
+    }
+    print_stats (&bench);
+    printf ("}\n");
+
+    kill (bench.wm_pid, SIGTERM);
+    waitpid (bench.wm_pid, &status, 0);
+    XCloseDisplay (bench.dpy);
+    free (bench.windows);
+
+    return 0;
+}
@@ -29,6 +29,7 @@
 #include <signal.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdlib.h>
 
 #include <X11/X.h>
 #include <X11/Xlib.h>
@@ -59,6 +60,7 @@
 #include "settings.h"
 #include "stacking.h"
 #include "startup_notification.h"
+#include "stats.h"
 #include "transients.h"
 #include "workspaces.h"
 #include "xsync.h"
@@ -104,6 +106,13 @@ struct _ButtonPressData
     Client *c;
 };
 
+typedef struct _ClientIcon ClientIcon;
+struct _ClientIcon
+{
+    gint size;
+    GdkPixbuf *pixbuf;
+};
+
 /* Forward decl */
 static void
 clientUpdateIconPix (Client *c);
@@ -158,7 +167,7 @@ clientUpdateColormaps (Client *c)
         XFree (c->cmap_windows);
         c->ncmap = 0;
     }
-    if (!XGetWMColormapWindows (clientGetXDisplay (c), c->window, &c->cmap_windows, &c->ncmap))
+    if (!getWMColormapWindows (c->screen_info->display_info, c->window, &c->cmap_windows, &c->ncmap))
     {
         c->cmap_windows = NULL;
         c->ncmap = 0;
@@ -239,10 +248,125 @@ clientUpdateName (Client *c)
 
     if (refresh)
     {
+        frameClearTitleCache (c);
         frameQueueDraw (c, TRUE);
     }
 }
 
+static void
+clientUpdatePendingProperties (Client *c)
+{
+    DisplayInfo *display_info;
+    unsigned long pending;
+
+    g_return_if_fail (c != NULL);
+    TRACE ("entering clientUpdatePendingProperties");
+
+    display_info = c->screen_info->display_info;
+    pending = c->pending_properties;
+    c->pending_properties = 0L;
+
+    if (pending & PENDING_PROPERTY_NAME)
+    {
+        clientUpdateName (c);
+    }
+    if (pending & PENDING_PROPERTY_USER_TIME)
+    {
+        clientGetUserTime (c);
+    }
+
+    /* WM_NAME is left unread when _NET_WM_NAME is set */
+    discardPrefetchedProperties (display_info, c->window);
+}
+
+/*
+ * Read the properties queued by clientQueuePropertyUpdate(), each
+ * property of a client is read only once however many notifications
+ * were received for it, from the replies requested meanwhile.
+ */
+void
+clientFlushPendingProperties (DisplayInfo *display_info)
+{
+    GSList *pending, *list;
+
+    g_return_if_fail (display_info != NULL);
+
+    if (display_info->pending_idle_id)
+    {
+        g_source_remove (display_info->pending_idle_id);
+        display_info->pending_idle_id = 0;
+    }
+
+    if (!display_info->pending_clients)
+    {
+        return;
+    }
+
+    TRACE ("entering clientFlushPendingProperties");
+
+    /* Apply the changes in the order they were received */
+    pending = g_slist_reverse (display_info->pending_clients);
+    display_info->pending_clients = NULL;
+
+    for (list = pending; list; list = g_slist_next (list))
+    {
+        clientUpdatePendingProperties ((Client *) list->data);
+    }
+    g_slist_free (pending);
+}
+
+static gboolean
+pending_properties_idle_cb (gpointer data)
+{
+    DisplayInfo *display_info;
+
+    TRACE ("entering pending_properties_idle_cb");
+
+    display_info = (DisplayInfo *) data;
+    display_info->pending_idle_id = 0;
+    clientFlushPendingProperties (display_info);
+
+    return (FALSE);
+}
+
+/*
+ * Request the new value of a property that changed without waiting for
+ * it, the reply is collected once the current burst of PropertyNotify
+ * events is processed so that chatty clients never block the main loop.
+ */
+void
+clientQueuePropertyUpdate (Client *c, unsigned long property)
+{
+    DisplayInfo *display_info;
+
+    g_return_if_fail (c != NULL);
+    TRACE ("entering clientQueuePropertyUpdate for \"%s\" (0x%lx)", c->name, c->window);
+
+    display_info = c->screen_info->display_info;
+    if (property & PENDING_PROPERTY_NAME)
+    {
+        prefetchWindowProperty (display_info, c->window, display_info->atoms[NET_WM_NAME]);
+        prefetchWindowProperty (display_info, c->window, XA_WM_NAME);
+        prefetchWindowProperty (display_info, c->window, display_info->atoms[WM_CLIENT_MACHINE]);
+    }
+    if (property & PENDING_PROPERTY_USER_TIME)
+    {
+        prefetchWindowProperty (display_info, c->user_time_win, display_info->atoms[NET_WM_USER_TIME]);
+    }
+    if (!c->pending_properties)
+    {
+        display_info->pending_clients = g_slist_prepend (display_info->pending_clients, c);
+    }
+    FLAG_SET (c->pending_properties, property);
+
+    if (display_info->pending_idle_id == 0)
+    {
+        display_info->pending_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                                                         pending_properties_idle_cb,
+                                                         display_info, NULL);
+    }
+}
+
 void
 clientUpdateAllFrames (ScreenInfo *screen_info, int mask)
 {
@@ -639,6 +763,7 @@ clientConfigure (Client *c, XWindowChanges * wc, unsigned long mask, unsigned sh
     g_return_if_fail (c->window != None);
 
     TRACE ("entering clientConfigure");
+    statsCount (STATS_CLIENT_CONFIGURE);
     TRACE ("configuring client \"%s\" (0x%lx) %s, type %u", c->name,
         c->window, flags & CFG_CONSTRAINED ? "constrained" : "not contrained", c->type);
 
@@ -1008,7 +1133,6 @@ clientGetWMNormalHints (Client *c, gboolean update)
 {
     XWindowChanges wc;
     unsigned long previous_value;
-    long dummy;
 
     g_return_if_fail (c != NULL);
     g_return_if_fail (c->window != None);
@@ -1022,8 +1146,7 @@ clientGetWMNormalHints (Client *c, gboolean update)
     }
     g_assert (c->size);
 
-    dummy = 0;
-    if (!XGetWMNormalHints (clientGetXDisplay (c), c->window, c->size, &dummy))
+    if (!getWMNormalHints (c->screen_info->display_info, c->window, c->size))
     {
         c->size->flags = 0;
     }
@@ -1230,9 +1353,14 @@ clientFree (Client *c)
     {
         g_source_remove (c->icon_timeout_id);
     }
-    if (c->frame_timeout_id)
+    frameClearQueueDraw (c);
+    if (c->pending_properties)
     {
-        g_source_remove (c->frame_timeout_id);
+        DisplayInfo *display_info = c->screen_info->display_info;
+
+        display_info->pending_clients = g_slist_remove (display_info->pending_clients, c);
+        discardPrefetchedProperties (display_info, c->window);
+        c->pending_properties = 0L;
     }
     if (c->ping_timeout_id)
     {
@@ -1256,6 +1384,10 @@ clientFree (Client *c)
         g_source_remove (c->xsync_timeout_id);
     }
 #endif /* HAVE_XSYNC */
+    if (c->resize_timeout_id)
+    {
+        g_source_remove (c->resize_timeout_id);
+    }
 #ifdef HAVE_LIBSTARTUP_NOTIFICATION
     if (c->startup_id)
     {
@@ -1371,7 +1503,6 @@ static void
 clientUpdateIconPix (Client *c)
 {
     ScreenInfo *screen_info;
-    DisplayInfo *display_info;
     gint size;
     GdkPixbuf *icon;
     int i;
@@ -1382,7 +1513,6 @@ clientUpdateIconPix (Client *c)
     TRACE ("entering clientUpdateIconPix for \"%s\" (0x%lx)", c->name, c->window);
 
     screen_info = c->screen_info;
-    display_info = screen_info->display_info;
 
     for (i = 0; i < STATE_TOGGLED; i++)
     {
@@ -1407,16 +1537,12 @@ clientUpdateIconPix (Client *c)
 
     if (size > 1)
     {
-        icon = getAppIcon (display_info, c->window, size, size);
-
-        for (i = 0; i < STATE_TOGGLED; i++)
+        icon = clientGetIcon (c, size);
+        if (icon)
         {
-            if (!xfwmPixmapNone(&c->appmenu[i]))
-            {
-                xfwmPixmapRenderGdkPixbuf (&c->appmenu[i], icon);
-            }
+            xfwmPixmapRenderGdkPixbuf (c->appmenu, STATE_TOGGLED, icon);
+            g_object_unref (icon);
         }
-        g_object_unref (icon);
     }
 }
 
@@ -1440,6 +1566,58 @@ update_icon_idle_cb (gpointer data)
     return (FALSE);
 }
 
+GdkPixbuf *
+clientGetIcon (Client *c, gint size)
+{
+    ClientIcon *cached;
+    GSList *list;
+
+    g_return_val_if_fail (c != NULL, NULL);
+
+    TRACE ("entering clientGetIcon for \"%s\" (0x%lx) at size %i", c->name, c->window, size);
+
+    for (list = c->icon_cache; list; list = g_slist_next (list))
+    {
+        cached = (ClientIcon *) list->data;
+        if (cached->size == size)
+        {
+            return g_object_ref (cached->pixbuf);
+        }
+    }
+
+    cached = g_new (ClientIcon, 1);
+    cached->size = size;
+    cached->pixbuf = getAppIcon (c->screen_info->display_info, c->window, size, size);
+    if (cached->pixbuf == NULL)
+    {
+        g_free (cached);
+        return NULL;
+    }
+    c->icon_cache = g_slist_prepend (c->icon_cache, cached);
+
+    return g_object_ref (cached->pixbuf);
+}
+
+void
+clientInvalidateIcon (Client *c)
+{
+    ClientIcon *cached;
+    GSList *list;
+
+    g_return_if_fail (c != NULL);
+
+    TRACE ("entering clientInvalidateIcon for \"%s\" (0x%lx)", c->name, c->window);
+
+    for (list = c->icon_cache; list; list = g_slist_next (list))
+    {
+        cached = (ClientIcon *) list->data;
+        g_object_unref (cached->pixbuf);
+        g_free (cached);
+    }
+    g_slist_free (c->icon_cache);
+    c->icon_cache = NULL;
+}
+
 void
 clientUpdateIcon (Client *c)
 {
@@ -1472,8 +1650,8 @@ clientSaveSizePos (Client *c)
     }
 }
 
-Client *
-clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
+static Client *
+clientFrameWin (DisplayInfo *display_info, Window w, gboolean recapture)
 {
     ScreenInfo *screen_info;
     XWindowAttributes attr;
@@ -1511,6 +1689,14 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
         return NULL;
     }
 
+    if (myDisplayGetClientFromWindow (display_info, w, SEARCH_WINDOW | SEARCH_FRAME))
+    {
+        TRACE ("Window 0x%lx is already managed", w);
+        myDisplayUngrabServer (display_info);
+        gdk_error_trap_pop ();
+        return NULL;
+    }
+
     if (w == screen_info->xfwm4_win)
     {
         TRACE ("Not managing our own event window");
@@ -1520,6 +1706,19 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
         return NULL;
     }
 
+    /*
+     * When recapturing existing windows, only the viewable ones get
+     * managed, the state is checked here while we hold the server grab.
+     */
+    if ((recapture) && (attr.map_state != IsViewable))
+    {
+        TRACE ("Not recapturing unviewable window 0x%lx", w);
+        compositorAddWindow (display_info, w, NULL);
+        myDisplayUngrabServer (display_info);
+        gdk_error_trap_pop ();
+        return NULL;
+    }
+
 #ifdef ENABLE_KDE_SYSTRAY_PROXY
     if (checkKdeSystrayWindow (display_info, w))
     {
@@ -1586,6 +1785,8 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
     c->xsync_counter = None;
     c->xsync_alarm = None;
     c->xsync_timeout_id = 0;
+    c->xsync_request_time = 0;
+    c->xsync_latency = 0;
     if (display_info->have_xsync)
     {
         getXSyncCounter (display_info, c->window, &c->xsync_counter);
@@ -1628,7 +1829,7 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
         c->button_status[i] = BUTTON_STATE_NORMAL;
     }
 
-    if (!XGetWMColormapWindows (display_info->dpy, c->window, &c->cmap_windows, &c->ncmap))
+    if (!getWMColormapWindows (display_info, c->window, &c->cmap_windows, &c->ncmap))
     {
         c->ncmap = 0;
     }
@@ -1654,19 +1855,25 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
 
     /* Timout for asynchronous icon update */
     c->icon_timeout_id = 0;
-    /* Timout for asynchronous frame update */
-    c->frame_timeout_id = 0;
+    /* Asynchronous frame update */
+    c->frame_queued = FALSE;
     /* Timeout for blinking on urgency */
     c->blink_timeout_id = 0;
     /* Ping timeout  */
     c->ping_timeout_id = 0;
     /* Ping timeout  */
     c->ping_time = 0;
+    /* Throttled configure while resizing */
+    c->resize_timeout_id = 0;
+    c->resize_time = 0;
+    c->resize_pending = FALSE;
+    /* Property changes to read */
+    c->pending_properties = 0L;
 
     c->class.res_name = NULL;
     c->class.res_class = NULL;
-    XGetClassHint (display_info->dpy, w, &c->class);
-    c->wmhints = XGetWMHints (display_info->dpy, c->window);
+    getClassHint (display_info, w, &c->class);
+    c->wmhints = getWMHints (display_info, c->window);
     c->group_leader = None;
     if (c->wmhints)
     {
@@ -1676,6 +1883,9 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
         }
     }
     c->client_leader = getClientLeader (display_info, c->window);
+    c->indexed_transient_for = None;
+    c->indexed_group_leader = None;
+    c->indexed_workspace = 0;
 
     TRACE ("\"%s\" (0x%lx) initial map_state = %s",
                 c->name, c->window,
@@ -1702,6 +1912,11 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
     clientGetMWMHints (c, FALSE);
     c->win_layer = WIN_LAYER_NORMAL;
     c->fullscreen_old_layer = c->win_layer;
+    c->stack_link = NULL;
+    c->stack_position = 0;
+    c->stack_layer = 0;
+    c->layer_next = NULL;
+    c->layer_prev = NULL;
 
     /* net_wm_user_time standard */
     c->user_time = 0;
@@ -1820,6 +2035,8 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
     {
         xfwmPixmapInit (screen_info, &c->appmenu[i]);
     }
+    frameInitTitleCache (c);
+    c->frame_shape = NULL;
 
     for (i = 0; i < SIDE_TOP; i++) /* Keep SIDE_TOP for later */
     {
@@ -1850,6 +2067,7 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
     {
         xfwmWindowCreate (screen_info, c->visual, c->depth, c->frame,
             &c->buttons[i], BUTTON_EVENT_MASK, None);
+        myDisplayAddClientWindow (display_info, MYWINDOW_XWINDOW (c->buttons[i]), c, SEARCH_BUTTON);
     }
     clientUpdateIconPix (c);
 
@@ -1914,6 +2132,19 @@ clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
     return c;
 }
 
+Client *
+clientFrame (DisplayInfo *display_info, Window w, gboolean recapture)
+{
+    Client *c;
+    gint64 start;
+
+    start = getCurrentTimeUsec ();
+    c = clientFrameWin (display_info, w, recapture);
+    statsTime (STATS_CLIENT_FRAME, getCurrentTimeUsec () - start);
+
+    return c;
+}
+
 void
 clientUnframe (Client *c, gboolean remap)
 {
@@ -1986,6 +2217,13 @@ clientUnframe (Client *c, gboolean remap)
     {
         xfwmPixmapFree (&c->appmenu[i]);
     }
+    clientInvalidateIcon (c);
+    frameClearTitleCache (c);
+    if (c->frame_shape)
+    {
+        gdk_region_destroy (c->frame_shape);
+        c->frame_shape = NULL;
+    }
     for (i = 0; i < BUTTON_COUNT; i++)
     {
         xfwmWindowDelete (&c->buttons[i]);
@@ -2005,8 +2243,10 @@ void
 clientFrameAll (ScreenInfo *screen_info)
 {
     DisplayInfo *display_info;
-    XWindowAttributes attr;
     xfwmWindow shield;
+    xcb_get_window_attributes_cookie_t *cookies;
+    xcb_get_window_attributes_reply_t *reply;
+    xcb_generic_error_t *error;
     Window w1, w2, *wins;
     unsigned int count, i;
 
@@ -2024,24 +2264,66 @@ clientFrameAll (ScreenInfo *screen_info)
                     EnterWindowMask,
                     FALSE);
 
+    statsCount (STATS_XSYNC);
     XSync (display_info->dpy, FALSE);
-    myDisplayGrabServer (display_info);
+    /*
+     * Do not hold the server grab for the whole adoption, that would
+     * freeze the display for as long as it takes to frame all the
+     * existing windows. Each window is grabbed only while it's being
+     * framed by clientFrame(), which reads its attributes under that
+     * grab: windows destroyed since XQueryTree() fail that read and
+     * are skipped, windows unmapped since are left to the compositor,
+     * and windows already managed (or our own frames) are ignored.
+     * Windows created or mapped meanwhile are caught by MapRequest.
+     */
     XQueryTree (display_info->dpy, screen_info->xroot, &w1, &w2, &wins, &count);
+
+    /*
+     * Rather than waiting for each property of each window in turn, ask
+     * for the attributes of all the windows at once, then for all the
+     * properties of the ones to be managed, so that clientFrame() finds
+     * the replies already there. PropertyChangeMask is selected first,
+     * so that a change made after the request is notified once the
+     * window is managed.
+     */
+    cookies = g_new0 (xcb_get_window_attributes_cookie_t, count);
     for (i = 0; i < count; i++)
     {
-        XGetWindowAttributes (display_info->dpy, wins[i], &attr);
-        if ((attr.map_state == IsViewable) && (attr.root == screen_info->xroot))
+        cookies[i] = xcb_get_window_attributes (display_info->xcb, wins[i]);
+    }
+    gdk_error_trap_push ();
+    for (i = 0; i < count; i++)
+    {
+        error = NULL;
+        reply = xcb_get_window_attributes_reply (display_info->xcb, cookies[i], &error);
+        if (error)
         {
-            Client *c = clientFrame (display_info, wins[i], TRUE);
-            if ((c) && ((screen_info->params->raise_on_click) || (screen_info->params->click_to_focus)))
-            {
-                clientGrabMouseButton (c);
-            }
+            free (error);
         }
-        else
+        if (!reply)
+        {
+            continue;
+        }
+        if ((reply->map_state == XCB_MAP_STATE_VIEWABLE) && !(reply->override_redirect) &&
+            (wins[i] != screen_info->xfwm4_win))
         {
-             compositorAddWindow (display_info, wins[i], NULL);
+            XSelectInput (display_info->dpy, wins[i], reply->your_event_mask | PropertyChangeMask);
+            prefetchClientProperties (display_info, wins[i]);
         }
+        free (reply);
+    }
+    g_free (cookies);
+    gdk_error_trap_pop ();
+
+    for (i = 0; i < count; i++)
+    {
+        Client *c = clientFrame (display_info, wins[i], TRUE);
+        if ((c) && ((screen_info->params->raise_on_click) || (screen_info->params->click_to_focus)))
+        {
+            clientGrabMouseButton (c);
+        }
+        /* Drop the replies left unused, e.g. if the window is gone */
+        discardPrefetchedProperties (display_info, wins[i]);
     }
     if (wins)
     {
@@ -2049,7 +2331,7 @@ clientFrameAll (ScreenInfo *screen_info)
     }
     clientFocusTop (screen_info, WIN_LAYER_FULLSCREEN, myDisplayGetCurrentTime (display_info));
     xfwmWindowDelete (&shield);
-    myDisplayUngrabServer (display_info);
+    statsCount (STATS_XSYNC);
     XSync (display_info->dpy, FALSE);
 }
 
@@ -2065,6 +2347,7 @@ clientUnframeAll (ScreenInfo *screen_info)
 
     display_info = screen_info->display_info;
     clientSetFocus (screen_info, NULL, myDisplayGetCurrentTime (display_info), FOCUS_IGNORE_MODAL);
+    statsCount (STATS_XSYNC);
     XSync (display_info->dpy, FALSE);
     myDisplayGrabServer (display_info);
     XQueryTree (display_info->dpy, screen_info->xroot, &w1, &w2, &wins, &count);
@@ -2077,6 +2360,7 @@ clientUnframeAll (ScreenInfo *screen_info)
         }
     }
     myDisplayUngrabServer (display_info);
+    statsCount (STATS_XSYNC);
     XSync(display_info->dpy, FALSE);
     if (wins)
     {
@@ -2168,6 +2452,7 @@ clientSetWorkspaceSingle (Client *c, guint ws)
         {
             setHint (display_info, c->window, NET_WM_DESKTOP, (unsigned long) ws);
         }
+        workspaceUpdateClient (c);
     }
     FLAG_SET (c->xfwm_flags, XFWM_FLAG_WORKSPACE_SET);
 }
@@ -2239,6 +2524,7 @@ clientShowSingle (Client *c, gboolean deiconify)
     {
         TRACE ("showing client \"%s\" (0x%lx)", c->name, c->window);
         FLAG_SET (c->xfwm_flags, XFWM_FLAG_VISIBLE);
+        workspaceUpdateClient (c);
         XMapWindow (display_info->dpy, c->frame);
         if (!FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
         {
@@ -2300,6 +2586,7 @@ clientWithdrawSingle (Client *c, GList *exclude_list, gboolean iconify)
     if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_VISIBLE))
     {
         FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_VISIBLE);
+        workspaceUpdateClient (c);
         c->ignore_unmap++;
         /* Adjust to urgency state as the window is not visible */
         clientUpdateUrgency (c);
@@ -2633,6 +2920,7 @@ clientSetLayer (Client *c, guint l)
             TRACE ("setting client \"%s\" (0x%lx) layer to %d", c2->name,
                 c2->window, l);
             c2->win_layer = l;
+            clientStackUpdateLayer (c2);
         }
     }
     g_list_free (list_of_windows);
@@ -2793,6 +3081,7 @@ clientStick (Client *c, gboolean include_transients)
             c2 = (Client *) list->data;
             TRACE ("Sticking client \"%s\" (0x%lx)", c2->name, c2->window);
             FLAG_SET (c2->flags, CLIENT_FLAG_STICKY);
+            workspaceUpdateClient (c2);
             setHint (display_info, c2->window, NET_WM_DESKTOP, (unsigned long) ALL_WORKSPACES);
             frameQueueDraw (c2, FALSE);
         }
@@ -2802,6 +3091,7 @@ clientStick (Client *c, gboolean include_transients)
     {
         TRACE ("Sticking client \"%s\" (0x%lx)", c->name, c->window);
         FLAG_SET (c->flags, CLIENT_FLAG_STICKY);
+        workspaceUpdateClient (c);
         setHint (display_info, c->window, NET_WM_DESKTOP, (unsigned long) ALL_WORKSPACES);
     }
     clientSetWorkspace (c, screen_info->current_ws, TRUE);
@@ -2831,6 +3121,7 @@ clientUnstick (Client *c, gboolean include_transients)
             c2 = (Client *) list->data;
             TRACE ("Unsticking client \"%s\" (0x%lx)", c2->name, c2->window);
             FLAG_UNSET (c2->flags, CLIENT_FLAG_STICKY);
+            workspaceUpdateClient (c2);
             setHint (display_info, c2->window, NET_WM_DESKTOP, (unsigned long) screen_info->current_ws);
             frameQueueDraw (c2, FALSE);
         }
@@ -2840,6 +3131,7 @@ clientUnstick (Client *c, gboolean include_transients)
     {
         TRACE ("Unsticking client \"%s\" (0x%lx)", c->name, c->window);
         FLAG_UNSET (c->flags, CLIENT_FLAG_STICKY);
+        workspaceUpdateClient (c);
         setHint (display_info, c->window, NET_WM_DESKTOP, (unsigned long) screen_info->current_ws);
     }
     clientSetWorkspace (c, screen_info->current_ws, TRUE);
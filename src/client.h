@@ -104,6 +104,11 @@
 #define CLIENT_XSYNC_TIMEOUT            1000 /* ms */
 #endif
 
+/* Minimum delay between two configures while resizing without XSync */
+#ifndef CLIENT_RESIZE_INTERVAL
+#define CLIENT_RESIZE_INTERVAL          16   /* ms */
+#endif
+
 #ifndef CLIENT_BLINK_TIMEOUT
 #define CLIENT_BLINK_TIMEOUT            500  /* ms */
 #endif
@@ -169,6 +174,9 @@
 #define WM_FLAG_URGENT                  (1L<<4)
 #define WM_FLAG_PING                    (1L<<5)
 
+#define PENDING_PROPERTY_NAME           (1L<<0)
+#define PENDING_PROPERTY_USER_TIME      (1L<<1)
+
 #define XFWM_FLAG_INITIAL_VALUES        XFWM_FLAG_HAS_BORDER | \
                                         XFWM_FLAG_HAS_MENU | \
                                         XFWM_FLAG_HAS_MAXIMIZE | \
@@ -248,6 +256,20 @@ typedef enum
 }
 tilePositionType;
 
+typedef struct
+{
+    xfwmPixmap pm_title;
+    xfwmPixmap pm_top;
+    gint width;
+    gint height;
+    gint top_left;
+    gint top_right;
+    gint left;
+    gint right;
+    gboolean valid;
+}
+TitleCache;
+
 struct _Client
 {
     /* Reference to our screen structure */
@@ -264,9 +286,27 @@ struct _Client
     xfwmWindow buttons[BUTTON_COUNT];
     Window client_leader;
     Window group_leader;
+    /* Keys under which the client is filed in the transients index */
+    Window indexed_transient_for;
+    Window indexed_group_leader;
+    /* Key under which the client is filed in the workspace index */
+    guint indexed_workspace;
     xfwmPixmap appmenu[STATE_TOGGLED];
+    /* Decoded application icons, one per requested size */
+    GSList *icon_cache;
+    /* Rendered title bar for the active and inactive states */
+    TitleCache title_cache[2];
+    PangoLayout *title_layout;
+    /* Last frame shape set on the server, NULL if set by the server */
+    GdkRegion *frame_shape;
     Colormap cmap;
     unsigned long win_layer;
+    /* Place in windows_stack and neighbours in the same layer, see stacking.c */
+    GList *stack_link;
+    guint stack_position;
+    guint stack_layer;
+    Client *layer_next;
+    Client *layer_prev;
     unsigned long serial;
     unsigned long initial_layer;
     Atom type_atom;
@@ -311,6 +351,8 @@ struct _Client
     unsigned long flags;
     unsigned long wm_flags;
     unsigned long xfwm_flags;
+    /* Property changes not read yet */
+    unsigned long pending_properties;
     gint fullscreen_monitors[4];
 
     /* Termination dialog */
@@ -318,12 +360,16 @@ struct _Client
     gint dialog_fd;
     /* Timout for asynchronous icon update */
     guint icon_timeout_id;
-    /* Timout for asynchronous frame update */
-    guint frame_timeout_id;
+    /* Queued for the next frame redraw pass of the screen */
+    gboolean frame_queued;
     /* Timout to manage blinking decorations for urgent windows */
     guint blink_timeout_id;
     /* Timout for asynchronous icon update */
     guint ping_timeout_id;
+    /* Timeout for the throttled configure while resizing */
+    guint resize_timeout_id;
+    gint64 resize_time;
+    gboolean resize_pending;
     /* Opacity for the compositor */
     guint opacity;
     guint opacity_applied;
@@ -341,6 +387,9 @@ struct _Client
     guint xsync_timeout_id;
     gboolean xsync_waiting;
     gboolean xsync_enabled;
+    /* When the last request was sent, and smoothed time to reply (usec) */
+    gint64 xsync_request_time;
+    gint64 xsync_latency;
 #endif /* HAVE_XSYNC */
 };
 
@@ -374,6 +423,9 @@ void                     clientGetWMNormalHints                 (Client *,
                                                                  gboolean);
 void                     clientGetWMProtocols                   (Client *);
 void                     clientUpdateIcon                       (Client *);
+GdkPixbuf               *clientGetIcon                          (Client *,
+                                                                 gint);
+void                     clientInvalidateIcon                   (Client *);
 void                     clientSaveSizePos                      (Client *);
 Client                  *clientFrame                            (DisplayInfo *,
                                                                  Window,
@@ -385,6 +437,9 @@ void                     clientUnframeAll                       (ScreenInfo *);
 void                     clientInstallColormaps                 (Client *);
 void                     clientUpdateColormaps                  (Client *);
 void                     clientUpdateName                       (Client *);
+void                     clientQueuePropertyUpdate              (Client *,
+                                                                 unsigned long);
+void                     clientFlushPendingProperties           (DisplayInfo *);
 void                     clientUpdateAllFrames                  (ScreenInfo *,
                                                                  gboolean);
 void                     clientGrabButtons                      (Client *);
@@ -41,7 +41,9 @@
 #include "client.h"
 #include "frame.h"
 #include "hints.h"
+#include "misc.h"
 #include "compositor.h"
+#include "stats.h"
 
 #ifdef HAVE_COMPOSITOR
 
@@ -84,9 +86,67 @@
 #define WIN_IS_VISIBLE(cw)              (WIN_IS_VIEWABLE(cw) && WIN_HAS_DAMAGE(cw))
 #define WIN_IS_DAMAGED(cw)              (cw->damaged)
 #define WIN_IS_REDIRECTED(cw)           (cw->redirected)
+#define WIN_HAS_SHADOW(cw)              ((cw->shadow) || (cw->shadow_tiles))
 
-/* Set TIMEOUT_REPAINT to 0 to disable timeout repaint */
-#define TIMEOUT_REPAINT       10 /* msec.) */
+/* Number of unused shadow pictures kept around for reuse */
+#ifndef SHADOW_CACHE_SIZE
+#define SHADOW_CACHE_SIZE 16
+#endif /* SHADOW_CACHE_SIZE */
+
+/*
+ * Set PACE_REPAINT to 0 to repaint after each event instead of
+ * pacing repaints on the refresh rate of the display.
+ */
+#define PACE_REPAINT          1
+
+/*
+ * Time a fullscreen window must stay on top of the stack before it gets
+ * unredirected, so that short lived windows mapped above it do not cause
+ * the window to be redirected and unredirected over and over again.
+ */
+#ifndef UNREDIRECT_DELAY
+#define UNREDIRECT_DELAY      500 /* ms */
+#endif /* UNREDIRECT_DELAY */
+
+/* Used when the refresh rate cannot be obtained from XRandR */
+#ifndef DEFAULT_REFRESH_RATE
+#define DEFAULT_REFRESH_RATE  60 /* Hz */
+#endif /* DEFAULT_REFRESH_RATE */
+
+/*
+ * Shadows of windows large enough to have all their corners built from
+ * the presummed gaussian only differ in the length of their sides, so
+ * they are composed at paint time from the same set of tiles.
+ */
+typedef struct _ShadowTiles ShadowTiles;
+struct _ShadowTiles
+{
+    gint opacity_int;
+    gint size;
+    Picture corners;
+    Picture top;
+    Picture bottom;
+    Picture left;
+    Picture right;
+    Picture center;
+};
+
+/* Other shadows are rendered once per size and opacity, and cached */
+typedef struct _ShadowCacheEntry ShadowCacheEntry;
+struct _ShadowCacheEntry
+{
+    gdouble opacity;
+    gint width;
+    gint height;
+    gint delta_x;
+    gint delta_y;
+    gint delta_width;
+    gint delta_height;
+    gint shadow_width;
+    gint shadow_height;
+    Picture picture;
+    guint refcount;
+};
 
 typedef struct _CWindow CWindow;
 struct _CWindow
@@ -103,6 +163,7 @@ struct _CWindow
     gboolean fulloverlay;
     gboolean argb;
     gboolean skipped;
+    gboolean occluded;
     gboolean native_opacity;
     gboolean opacity_locked;
 
@@ -112,6 +173,7 @@ struct _CWindow
 #endif /* HAVE_NAME_WINDOW_PIXMAP */
     Picture picture;
     Picture shadow;
+    ShadowTiles *shadow_tiles;
     Picture alphaPict;
     Picture shadowPict;
     Picture alphaBorderPict;
@@ -129,45 +191,14 @@ struct _CWindow
     guint opacity;
 };
 
-static CWindow*
-find_cwindow_in_screen (ScreenInfo *screen_info, Window id)
-{
-    GList *list;
-
-    g_return_val_if_fail (id != None, NULL);
-    g_return_val_if_fail (screen_info != NULL, NULL);
-    TRACE ("entering find_cwindow_in_screen");
-
-    for (list = screen_info->cwindows; list; list = g_list_next (list))
-    {
-        CWindow *cw = (CWindow *) list->data;
-        if (cw->id == id)
-        {
-            return cw;
-        }
-    }
-    return NULL;
-}
-
 static CWindow*
 find_cwindow_in_display (DisplayInfo *display_info, Window id)
 {
-    GSList *list;
-
     g_return_val_if_fail (id != None, NULL);
     g_return_val_if_fail (display_info != NULL, NULL);
     TRACE ("entering find_cwindow_in_display");
 
-    for (list = display_info->screens; list; list = g_slist_next (list))
-    {
-        ScreenInfo *screen_info = (ScreenInfo *) list->data;
-        CWindow *cw = find_cwindow_in_screen (screen_info, id);
-        if (cw)
-        {
-            return (cw);
-        }
-    }
-    return NULL;
+    return (CWindow *) g_hash_table_lookup (display_info->cwindow_hash, (gconstpointer) id);
 }
 
 static gboolean
@@ -211,6 +242,26 @@ is_fullscreen (CWindow *cw)
             (cw->attr.height + 2 * cw->attr.border_width == rect.height));
 }
 
+/*
+ * Unredirecting a window unmaps the overlay for the whole screen, so a
+ * window filling one monitor only qualifies when there is no other
+ * monitor whose composited content would go blank.
+ */
+static gboolean
+covers_screen (CWindow *cw)
+{
+    if (WIN_IS_FULLSCREEN(cw))
+    {
+        return TRUE;
+    }
+    if (myScreenGetNumMonitors (cw->screen_info) > 1)
+    {
+        return FALSE;
+    }
+
+    return is_fullscreen (cw);
+}
+
 static gdouble
 gaussian (gdouble r, gdouble x, gdouble y)
 {
@@ -610,6 +661,343 @@ shadow_picture (ScreenInfo *screen_info, gdouble opacity,
     return shadowPicture;
 }
 
+static Picture
+shadow_strip (ScreenInfo *screen_info, Picture src, gint x, gint y, gint width, gint height)
+{
+    DisplayInfo *display_info;
+    XRenderPictureAttributes pa;
+    XRenderPictFormat *render_format;
+    Pixmap pixmap;
+    Picture picture;
+
+    display_info = screen_info->display_info;
+    render_format = XRenderFindStandardFormat (display_info->dpy, PictStandardA8);
+    g_return_val_if_fail (render_format != NULL, None);
+
+    pixmap = XCreatePixmap (display_info->dpy, screen_info->output, width, height, 8);
+    g_return_val_if_fail (pixmap != None, None);
+
+    pa.repeat = TRUE;
+    picture = XRenderCreatePicture (display_info->dpy, pixmap,
+                                    render_format, CPRepeat, &pa);
+    XFreePixmap (display_info->dpy, pixmap);
+    if (picture == None)
+    {
+        g_warning ("(picture != None) failed");
+        return None;
+    }
+
+    /* Copied server side, from the tiles already uploaded */
+    XRenderComposite (display_info->dpy, PictOpSrc, src, None, picture,
+                      x, y, 0, 0, 0, 0, width, height);
+
+    return picture;
+}
+
+static void
+free_shadow_tiles (ScreenInfo *screen_info, ShadowTiles *tiles)
+{
+    DisplayInfo *display_info;
+
+    display_info = screen_info->display_info;
+    if (tiles->corners)
+    {
+        XRenderFreePicture (display_info->dpy, tiles->corners);
+    }
+    if (tiles->top)
+    {
+        XRenderFreePicture (display_info->dpy, tiles->top);
+    }
+    if (tiles->bottom)
+    {
+        XRenderFreePicture (display_info->dpy, tiles->bottom);
+    }
+    if (tiles->left)
+    {
+        XRenderFreePicture (display_info->dpy, tiles->left);
+    }
+    if (tiles->right)
+    {
+        XRenderFreePicture (display_info->dpy, tiles->right);
+    }
+    if (tiles->center)
+    {
+        XRenderFreePicture (display_info->dpy, tiles->center);
+    }
+    g_free (tiles);
+}
+
+static ShadowTiles *
+get_shadow_tiles (ScreenInfo *screen_info, gdouble opacity)
+{
+    ShadowTiles *tiles;
+    GList *list;
+    gint opacity_int;
+    gint size, width, height;
+    gint w, h;
+
+    g_return_val_if_fail (screen_info != NULL, NULL);
+    TRACE ("entering get_shadow_tiles");
+
+    opacity_int = (gint) (opacity * 25);
+    for (list = screen_info->shadow_tiles; list; list = g_list_next (list))
+    {
+        tiles = (ShadowTiles *) list->data;
+        if (tiles->opacity_int == opacity_int)
+        {
+            return tiles;
+        }
+    }
+
+    /*
+     * The smallest shadow still using the presummed corners has each
+     * corner followed by a single row or column of its sides.
+     */
+    size = screen_info->gaussianSize;
+    width = size + 1 + screen_info->params->shadow_delta_width + screen_info->params->shadow_delta_x;
+    height = size + 1 + screen_info->params->shadow_delta_height + screen_info->params->shadow_delta_y;
+    if ((width < 1) || (height < 1))
+    {
+        return NULL;
+    }
+
+    tiles = g_new0 (ShadowTiles, 1);
+    tiles->opacity_int = opacity_int;
+    tiles->size = size;
+    tiles->corners = shadow_picture (screen_info, opacity, width, height, &w, &h);
+    if ((tiles->corners == None) || (w != 2 * size + 1) || (h != 2 * size + 1))
+    {
+        free_shadow_tiles (screen_info, tiles);
+        return NULL;
+    }
+    tiles->top = shadow_strip (screen_info, tiles->corners, size, 0, 1, size);
+    tiles->bottom = shadow_strip (screen_info, tiles->corners, size, size + 1, 1, size);
+    tiles->left = shadow_strip (screen_info, tiles->corners, 0, size, size, 1);
+    tiles->right = shadow_strip (screen_info, tiles->corners, size + 1, size, size, 1);
+    tiles->center = shadow_strip (screen_info, tiles->corners, size, size, 1, 1);
+
+    screen_info->shadow_tiles = g_list_prepend (screen_info->shadow_tiles, tiles);
+
+    return tiles;
+}
+
+static void
+paint_shadow_tiles (CWindow *cw, Picture dest)
+{
+    DisplayInfo *display_info;
+    ScreenInfo *screen_info;
+    ShadowTiles *tiles;
+    Picture src;
+    gint x, y, w, h, s;
+
+    g_return_if_fail (cw != NULL);
+    g_return_if_fail (cw->shadow_tiles != NULL);
+    TRACE ("entering paint_shadow_tiles 0x%lx", cw->id);
+
+    screen_info = cw->screen_info;
+    display_info = screen_info->display_info;
+    tiles = cw->shadow_tiles;
+    src = screen_info->blackPicture;
+    s = tiles->size;
+    x = cw->attr.x + cw->shadow_dx;
+    y = cw->attr.y + cw->shadow_dy;
+    w = cw->shadow_width;
+    h = cw->shadow_height;
+
+    /* Corners */
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->corners, dest,
+                      0, 0, 0, 0, x, y, s, s);
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->corners, dest,
+                      0, 0, s + 1, 0, x + w - s, y, s, s);
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->corners, dest,
+                      0, 0, 0, s + 1, x, y + h - s, s, s);
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->corners, dest,
+                      0, 0, s + 1, s + 1, x + w - s, y + h - s, s, s);
+
+    /* Sides, repeated along their length */
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->top, dest,
+                      0, 0, 0, 0, x + s, y, w - 2 * s, s);
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->bottom, dest,
+                      0, 0, 0, 0, x + s, y + h - s, w - 2 * s, s);
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->left, dest,
+                      0, 0, 0, 0, x, y + s, s, h - 2 * s);
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->right, dest,
+                      0, 0, 0, 0, x + w - s, y + s, s, h - 2 * s);
+
+    /* Center */
+    XRenderComposite (display_info->dpy, PictOpOver, src, tiles->center, dest,
+                      0, 0, 0, 0, x + s, y + s, w - 2 * s, h - 2 * s);
+}
+
+static void
+trim_shadow_cache (ScreenInfo *screen_info, guint max_unused)
+{
+    DisplayInfo *display_info;
+    GList *list, *prev;
+    guint unused;
+
+    display_info = screen_info->display_info;
+    unused = 0;
+
+    /* Most recently used entries are first */
+    for (list = screen_info->shadow_cache; list; list = g_list_next (list))
+    {
+        ShadowCacheEntry *entry = (ShadowCacheEntry *) list->data;
+        if (entry->refcount == 0)
+        {
+            unused++;
+        }
+    }
+
+    list = g_list_last (screen_info->shadow_cache);
+    while ((list) && (unused > max_unused))
+    {
+        ShadowCacheEntry *entry = (ShadowCacheEntry *) list->data;
+
+        prev = g_list_previous (list);
+        if (entry->refcount == 0)
+        {
+            XRenderFreePicture (display_info->dpy, entry->picture);
+            g_free (entry);
+            screen_info->shadow_cache = g_list_delete_link (screen_info->shadow_cache, list);
+            unused--;
+        }
+        list = prev;
+    }
+}
+
+static Picture
+get_shadow_picture (ScreenInfo *screen_info, gdouble opacity,
+                    gint width, gint height, gint *wp, gint *hp)
+{
+    ShadowCacheEntry *entry;
+    XfwmParams *params;
+    GList *list;
+    Picture picture;
+
+    g_return_val_if_fail (screen_info != NULL, None);
+    TRACE ("entering get_shadow_picture");
+
+    params = screen_info->params;
+    for (list = screen_info->shadow_cache; list; list = g_list_next (list))
+    {
+        entry = (ShadowCacheEntry *) list->data;
+        if ((entry->width == width) && (entry->height == height) &&
+            (entry->opacity == opacity) &&
+            (entry->delta_x == params->shadow_delta_x) &&
+            (entry->delta_y == params->shadow_delta_y) &&
+            (entry->delta_width == params->shadow_delta_width) &&
+            (entry->delta_height == params->shadow_delta_height))
+        {
+            screen_info->shadow_cache = g_list_remove_link (screen_info->shadow_cache, list);
+            screen_info->shadow_cache = g_list_concat (list, screen_info->shadow_cache);
+            entry->refcount++;
+            *wp = entry->shadow_width;
+            *hp = entry->shadow_height;
+
+            return entry->picture;
+        }
+    }
+
+    picture = shadow_picture (screen_info, opacity, width, height, wp, hp);
+    if (picture == None)
+    {
+        return None;
+    }
+
+    entry = g_new0 (ShadowCacheEntry, 1);
+    entry->opacity = opacity;
+    entry->width = width;
+    entry->height = height;
+    entry->delta_x = params->shadow_delta_x;
+    entry->delta_y = params->shadow_delta_y;
+    entry->delta_width = params->shadow_delta_width;
+    entry->delta_height = params->shadow_delta_height;
+    entry->shadow_width = *wp;
+    entry->shadow_height = *hp;
+    entry->picture = picture;
+    entry->refcount = 1;
+    screen_info->shadow_cache = g_list_prepend (screen_info->shadow_cache, entry);
+    trim_shadow_cache (screen_info, SHADOW_CACHE_SIZE);
+
+    return picture;
+}
+
+static void
+release_shadow_picture (ScreenInfo *screen_info, Picture picture)
+{
+    GList *list;
+
+    for (list = screen_info->shadow_cache; list; list = g_list_next (list))
+    {
+        ShadowCacheEntry *entry = (ShadowCacheEntry *) list->data;
+        if (entry->picture == picture)
+        {
+            if (entry->refcount > 0)
+            {
+                entry->refcount--;
+            }
+            trim_shadow_cache (screen_info, SHADOW_CACHE_SIZE);
+            return;
+        }
+    }
+
+    /* Not from the cache */
+    XRenderFreePicture (screen_info->display_info->dpy, picture);
+}
+
+static void
+free_win_shadow (CWindow *cw)
+{
+    if (cw->shadow)
+    {
+        release_shadow_picture (cw->screen_info, cw->shadow);
+        cw->shadow = None;
+    }
+    /* Tiles are shared and owned by the screen */
+    cw->shadow_tiles = NULL;
+}
+
+static void
+get_win_shadow (CWindow *cw, gdouble opacity, gint width, gint height)
+{
+    ScreenInfo *screen_info;
+    gint size;
+
+    screen_info = cw->screen_info;
+    size = screen_info->gaussianSize;
+    cw->shadow_width = width + size - screen_info->params->shadow_delta_width - screen_info->params->shadow_delta_x;
+    cw->shadow_height = height + size - screen_info->params->shadow_delta_height - screen_info->params->shadow_delta_y;
+
+    /* Large enough to be composed from the tiles, whatever its size */
+    if ((size > 0) && (cw->shadow_width > 2 * size) && (cw->shadow_height > 2 * size))
+    {
+        cw->shadow_tiles = get_shadow_tiles (screen_info, opacity);
+        if (cw->shadow_tiles)
+        {
+            return;
+        }
+    }
+
+    cw->shadow = get_shadow_picture (screen_info, opacity, width, height,
+                                     &cw->shadow_width, &cw->shadow_height);
+}
+
+static void
+free_shadow_cache (ScreenInfo *screen_info)
+{
+    GList *list;
+
+    for (list = screen_info->shadow_tiles; list; list = g_list_next (list))
+    {
+        free_shadow_tiles (screen_info, (ShadowTiles *) list->data);
+    }
+    g_list_free (screen_info->shadow_tiles);
+    screen_info->shadow_tiles = NULL;
+
+    trim_shadow_cache (screen_info, 0);
+}
+
 static Picture
 solid_picture (ScreenInfo *screen_info, gboolean argb,
                gdouble a, gdouble r, gdouble g, gdouble b)
@@ -730,11 +1118,7 @@ free_win_data (CWindow *cw, gboolean delete)
         cw->picture = None;
     }
 
-    if (cw->shadow)
-    {
-        XRenderFreePicture (display_info->dpy, cw->shadow);
-        cw->shadow = None;
-    }
+    free_win_shadow (cw);
 
     if (cw->alphaPict)
     {
@@ -824,6 +1208,7 @@ root_tile (ScreenInfo *screen_info)
         guchar *prop;
         gint result;
 
+        statsCount (STATS_GET_PROPERTY);
         result = XGetWindowProperty (dpy, screen_info->xroot, backgroundProps[p],
                                 0, 4, False, AnyPropertyType,
                                 &actual_type, &actual_format, &nitems, &bytes_after, &prop);
@@ -974,7 +1359,7 @@ win_extents (CWindow *cw)
         cw->shadow_dx = SHADOW_OFFSET_X + screen_info->params->shadow_delta_x;
         cw->shadow_dy = SHADOW_OFFSET_Y + screen_info->params->shadow_delta_y;
 
-        if (!(cw->shadow))
+        if (!WIN_HAS_SHADOW(cw))
         {
             double shadow_opacity;
             shadow_opacity = (double) screen_info->params->frame_opacity
@@ -982,10 +1367,9 @@ win_extents (CWindow *cw)
                            * cw->opacity
                            / (NET_WM_OPAQUE * 100.0);
 
-            cw->shadow = shadow_picture (screen_info, shadow_opacity,
-                                         cw->attr.width + 2 * cw->attr.border_width,
-                                         cw->attr.height + 2 * cw->attr.border_width,
-                                         &cw->shadow_width, &cw->shadow_height);
+            get_win_shadow (cw, shadow_opacity,
+                            cw->attr.width + 2 * cw->attr.border_width,
+                            cw->attr.height + 2 * cw->attr.border_width);
         }
 
         sr.x = cw->attr.x + cw->shadow_dx;
@@ -1012,10 +1396,9 @@ win_extents (CWindow *cw)
             r.height = sr.y + sr.height - r.y;
         }
     }
-    else if (cw->shadow)
+    else if (WIN_HAS_SHADOW(cw))
     {
-        XRenderFreePicture (display_info->dpy, cw->shadow);
-        cw->shadow = None;
+        free_win_shadow (cw);
     }
     return XFixesCreateRegion (display_info->dpy, &r, 1);
 }
@@ -1090,32 +1473,229 @@ get_window_picture (CWindow *cw)
     format = get_window_format (cw);
     if (format)
     {
-        pa.subwindow_mode = IncludeInferiors;
-        return XRenderCreatePicture (display_info->dpy, draw, format, CPSubwindowMode, &pa);
+        pa.subwindow_mode = IncludeInferiors;
+        return XRenderCreatePicture (display_info->dpy, draw, format, CPSubwindowMode, &pa);
+    }
+    return None;
+}
+
+static void
+unredirect_win (CWindow *cw)
+{
+    ScreenInfo *screen_info;
+    DisplayInfo *display_info;
+
+    g_return_if_fail (cw != NULL);
+    TRACE ("entering unredirect_win");
+
+    if (WIN_IS_REDIRECTED(cw))
+    {
+        screen_info = cw->screen_info;
+        display_info = screen_info->display_info;
+
+        free_win_data (cw, FALSE);
+        cw->redirected = FALSE;
+
+        XCompositeUnredirectWindow (display_info->dpy, cw->id, display_info->composite_mode);
+        TRACE ("Window 0x%lx unredirected, wins_unredirected is %i", cw->id, screen_info->wins_unredirected);
+    }
+}
+
+static gboolean
+can_unredirect_fullscreen (CWindow *cw)
+{
+    return (cw->screen_info->params->unredirect_overlays &&
+            WIN_IS_REDIRECTED(cw) && WIN_IS_DAMAGED(cw) &&
+            WIN_IS_NATIVE_OPAQUE(cw) && (cw->opacity == NET_WM_OPAQUE) &&
+            !WIN_IS_SHAPED(cw) && covers_screen (cw));
+}
+
+/*
+ * Returns the top most window that the compositor would have to paint,
+ * windows already unredirected on their own (such as tooltips over an
+ * unredirected fullscreen window) are not accounted for.
+ */
+static CWindow *
+get_top_window (ScreenInfo *screen_info)
+{
+    GList *list;
+    CWindow *cw;
+
+    for (list = screen_info->cwindows; list; list = g_list_next (list))
+    {
+        cw = (CWindow *) list->data;
+        if (!WIN_IS_VISIBLE(cw))
+        {
+            continue;
+        }
+        if (!WIN_IS_REDIRECTED(cw) && (cw->id != screen_info->unredirect_win))
+        {
+            continue;
+        }
+        return cw;
+    }
+
+    return NULL;
+}
+
+static void
+unredirect_fullscreen (CWindow *cw)
+{
+    ScreenInfo *screen_info;
+    DisplayInfo *display_info;
+
+    g_return_if_fail (cw != NULL);
+    TRACE ("entering unredirect_fullscreen 0x%lx", cw->id);
+
+    screen_info = cw->screen_info;
+    display_info = screen_info->display_info;
+
+    unredirect_win (cw);
+    invalidate_occlusion (screen_info);
+    cw->fulloverlay = TRUE;
+    screen_info->unredirect_win = cw->id;
+    screen_info->unredirect_candidate = None;
+    screen_info->unredirect_start = getCurrentTimeUsec ();
+    screen_info->unredirect_count++;
+
+    screen_info->wins_unredirected++;
+    TRACE ("Fullscreen window 0x%lx unredirected, wins_unredirected increased to %i", cw->id, screen_info->wins_unredirected);
+#if HAVE_OVERLAYS
+    if ((screen_info->wins_unredirected == 1) && (display_info->have_overlays))
+    {
+        TRACE ("Unmapping overlay window");
+        XUnmapWindow (display_info->dpy, screen_info->overlay);
+    }
+#endif /* HAVE_OVERLAYS */
+}
+
+static void
+redirect_fullscreen (CWindow *cw)
+{
+    ScreenInfo *screen_info;
+    DisplayInfo *display_info;
+
+    g_return_if_fail (cw != NULL);
+    TRACE ("entering redirect_fullscreen 0x%lx", cw->id);
+
+    screen_info = cw->screen_info;
+    display_info = screen_info->display_info;
+
+    /* The window may be gone already */
+    gdk_error_trap_push ();
+    XCompositeRedirectWindow (display_info->dpy, cw->id, display_info->composite_mode);
+    gdk_error_trap_pop ();
+
+    invalidate_occlusion (screen_info);
+    cw->redirected = TRUE;
+    cw->fulloverlay = FALSE;
+    screen_info->unredirect_win = None;
+    screen_info->unredirect_time += getCurrentTimeUsec () - screen_info->unredirect_start;
+
+    if (screen_info->wins_unredirected > 0)
+    {
+        screen_info->wins_unredirected--;
+    }
+    TRACE ("Fullscreen window 0x%lx redirected, wins_unredirected decreased to %i", cw->id, screen_info->wins_unredirected);
+#if HAVE_OVERLAYS
+    if ((screen_info->wins_unredirected == 0) && (display_info->have_overlays))
+    {
+        TRACE ("Remapping overlay window");
+        XMapWindow (display_info->dpy, screen_info->overlay);
     }
-    return None;
+#endif /* HAVE_OVERLAYS */
 }
 
 static void
-unredirect_win (CWindow *cw)
+remove_unredirect_timeout (ScreenInfo *screen_info)
+{
+    if (screen_info->unredirect_timeout_id != 0)
+    {
+        g_source_remove (screen_info->unredirect_timeout_id);
+        screen_info->unredirect_timeout_id = 0;
+    }
+}
+
+static gboolean
+unredirect_timeout_cb (gpointer data)
 {
     ScreenInfo *screen_info;
-    DisplayInfo *display_info;
+    CWindow *cw;
 
-    g_return_if_fail (cw != NULL);
-    TRACE ("entering unredirect_win");
+    screen_info = (ScreenInfo *) data;
+    screen_info->unredirect_timeout_id = 0;
 
-    if (WIN_IS_REDIRECTED(cw))
+    /* Check that the candidate is still on top and eligible */
+    cw = get_top_window (screen_info);
+    if ((cw) && (cw->id == screen_info->unredirect_candidate) &&
+        (screen_info->unredirect_win == None) && can_unredirect_fullscreen (cw))
     {
-        screen_info = cw->screen_info;
-        display_info = screen_info->display_info;
+        TRACE ("Unredirecting fullscreen window 0x%lx", cw->id);
+        unredirect_fullscreen (cw);
+    }
 
-        free_win_data (cw, FALSE);
-        cw->redirected = FALSE;
+    return FALSE;
+}
 
-        XCompositeUnredirectWindow (display_info->dpy, cw->id, display_info->composite_mode);
-        TRACE ("Window 0x%lx unredirected, wins_unredirected is %i", cw->id, screen_info->wins_unredirected);
+/*
+ * Decide, on each repaint, whether the top most window is an opaque
+ * fullscreen window that can be unredirected so that it bypasses the
+ * compositor. The window is redirected again as soon as something else
+ * needs to be painted above it, but it is unredirected again only once
+ * it stayed on top for UNREDIRECT_DELAY.
+ *
+ * Returns TRUE if the window was redirected and the screen needs a full
+ * repaint.
+ */
+static gboolean
+update_unredirect (ScreenInfo *screen_info)
+{
+    DisplayInfo *display_info;
+    CWindow *top, *cw;
+    gboolean redirected;
+
+    display_info = screen_info->display_info;
+    redirected = FALSE;
+    top = get_top_window (screen_info);
+
+    if (screen_info->unredirect_win != None)
+    {
+        if ((top) && (top->id == screen_info->unredirect_win) &&
+            screen_info->params->unredirect_overlays && covers_screen (top))
+        {
+            return FALSE;
+        }
+        cw = find_cwindow_in_display (display_info, screen_info->unredirect_win);
+        if (cw)
+        {
+            TRACE ("Redirecting fullscreen window 0x%lx", cw->id);
+            redirect_fullscreen (cw);
+            redirected = TRUE;
+        }
+        else
+        {
+            screen_info->unredirect_win = None;
+        }
+        top = get_top_window (screen_info);
+    }
+
+    if ((top) && can_unredirect_fullscreen (top))
+    {
+        if (top->id != screen_info->unredirect_candidate)
+        {
+            remove_unredirect_timeout (screen_info);
+            screen_info->unredirect_candidate = top->id;
+            screen_info->unredirect_timeout_id =
+                g_timeout_add (UNREDIRECT_DELAY, unredirect_timeout_cb, screen_info);
+        }
+    }
+    else if (screen_info->unredirect_candidate != None)
+    {
+        remove_unredirect_timeout (screen_info);
+        screen_info->unredirect_candidate = None;
     }
+
+    return redirected;
 }
 
 static void
@@ -1214,6 +1794,7 @@ paint_win (CWindow *cw, XserverRegion region, gboolean solid_part)
             r.width = frame_width - frame_left - frame_right;
             r.height = frame_height - frame_top - frame_bottom;
             client_region = XFixesCreateRegion (display_info->dpy, &r, 1);
+            screen_info->regions_created++;
             XFixesSubtractRegion (display_info->dpy, region, region, client_region);
             XFixesDestroyRegion (display_info->dpy, client_region);
         }
@@ -1247,11 +1828,134 @@ paint_win (CWindow *cw, XserverRegion region, gboolean solid_part)
     }
 }
 
+static void
+invalidate_occlusion (ScreenInfo *screen_info)
+{
+    screen_info->occlusion_valid = FALSE;
+}
+
+/* The part of the window known to be opaque, in root coordinates */
+static GdkRegion *
+get_opaque_region (CWindow *cw)
+{
+    GdkRectangle rect;
+    GdkRegion *opaque;
+
+    if (WIN_HAS_FRAME(cw))
+    {
+        Client *c = cw->c;
+
+        rect.x = frameX (c) + frameLeft (c);
+        rect.y = frameY (c) + frameTop (c);
+        rect.width = frameWidth (c) - frameLeft (c) - frameRight (c);
+        rect.height = frameHeight (c) - frameTop (c) - frameBottom (c);
+
+        /*
+         * The frame bounding shape leaves out the rounded corners and
+         * the transparent parts of the theme. When it is not known,
+         * or the frame is translucent, only count the client area.
+         */
+        if ((cw->screen_info->params->frame_opacity < 100) || !(c->frame_shape))
+        {
+            return gdk_region_rectangle (&rect);
+        }
+        opaque = gdk_region_copy (c->frame_shape);
+        gdk_region_offset (opaque, frameX (c), frameY (c));
+        if ((rect.width > 0) && (rect.height > 0))
+        {
+            gdk_region_union_with_rect (opaque, &rect);
+        }
+        return opaque;
+    }
+
+    rect.x = cw->attr.x;
+    rect.y = cw->attr.y;
+    rect.width = cw->attr.width + 2 * cw->attr.border_width;
+    rect.height = cw->attr.height + 2 * cw->attr.border_width;
+
+    return gdk_region_rectangle (&rect);
+}
+
+static void
+get_extents_rect (CWindow *cw, GdkRectangle *rect)
+{
+    rect->x = cw->attr.x;
+    rect->y = cw->attr.y;
+    rect->width = cw->attr.width + 2 * cw->attr.border_width;
+    rect->height = cw->attr.height + 2 * cw->attr.border_width;
+
+    if (WIN_HAS_SHADOW(cw))
+    {
+        GdkRectangle shadow;
+
+        shadow.x = cw->attr.x + cw->shadow_dx;
+        shadow.y = cw->attr.y + cw->shadow_dy;
+        shadow.width = cw->shadow_width;
+        shadow.height = cw->shadow_height;
+        gdk_rectangle_union (rect, &shadow, rect);
+    }
+}
+
+/*
+ * Mark the windows entirely hidden behind opaque windows, so that
+ * paint_all () can skip them. This is computed on the client side
+ * from the window geometries and only when the stack, the size,
+ * the shape, the mapping or the opacity of a window has changed.
+ */
+static void
+update_occlusion (ScreenInfo *screen_info)
+{
+    GdkRegion *covered;
+    GdkRegion *opaque;
+    GdkRectangle rect;
+    GList *list;
+    CWindow *cw;
+
+    TRACE ("entering update_occlusion");
+
+    covered = gdk_region_new ();
+    for (list = screen_info->cwindows; list; list = g_list_next (list))
+    {
+        cw = (CWindow *) list->data;
+        cw->occluded = FALSE;
+
+        if (!WIN_IS_VISIBLE(cw) || !WIN_IS_DAMAGED(cw) || !WIN_IS_REDIRECTED(cw))
+        {
+            continue;
+        }
+
+        if (cw->extents == None)
+        {
+            cw->extents = win_extents (cw);
+        }
+
+        get_extents_rect (cw, &rect);
+        if (gdk_region_rect_in (covered, &rect) == GDK_OVERLAP_RECTANGLE_IN)
+        {
+            TRACE ("window 0x%lx is occluded", cw->id);
+            cw->occluded = TRUE;
+            continue;
+        }
+
+        /* Shaped windows may have holes, do not count them */
+        if (WIN_IS_OPAQUE(cw) && !WIN_IS_SHAPED(cw))
+        {
+            opaque = get_opaque_region (cw);
+            gdk_region_union (covered, opaque);
+            gdk_region_destroy (opaque);
+        }
+    }
+    gdk_region_destroy (covered);
+
+    screen_info->occlusion_valid = TRUE;
+}
+
 static void
 paint_all (ScreenInfo *screen_info, XserverRegion region)
 {
     DisplayInfo *display_info;
     XserverRegion paint_region;
+    XserverRegion shadowClip;
     Display *dpy;
     GList *list;
     gint screen_width;
@@ -1273,9 +1977,19 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
         g_return_if_fail (screen_info->rootBuffer != None);
     }
 
+    if (!screen_info->occlusion_valid)
+    {
+        update_occlusion (screen_info);
+    }
+    screen_info->wins_painted = 0;
+    screen_info->wins_occluded = 0;
+    screen_info->regions_created = 0;
+
     /* Copy the original given region */
     paint_region = XFixesCreateRegion (dpy, NULL, 0);
     XFixesCopyRegion (dpy, paint_region, region);
+    screen_info->regions_created++;
+    shadowClip = None;
 
     /* Set clipping to the given region */
     XFixesSetPictureClipRegion (dpy, screen_info->rootPicture, 0, 0, paint_region);
@@ -1302,6 +2016,14 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
             continue;
         }
 
+        if (cw->occluded)
+        {
+            TRACE ("skipped, occluded 0x%lx", cw->id);
+            screen_info->wins_occluded++;
+            cw->skipped = TRUE;
+            continue;
+        }
+
         if ((cw->attr.x + cw->attr.width < 1) || (cw->attr.y + cw->attr.height < 1) ||
             (cw->attr.x >= screen_width) || (cw->attr.y >= screen_height))
         {
@@ -1330,12 +2052,15 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
         {
             paint_win (cw, paint_region, TRUE);
         }
+        /* The clip region is kept from one frame to another */
         if (cw->borderClip == None)
         {
             cw->borderClip = XFixesCreateRegion (dpy, NULL, 0);
-            XFixesCopyRegion (dpy, cw->borderClip, paint_region);
+            screen_info->regions_created++;
         }
+        XFixesCopyRegion (dpy, cw->borderClip, paint_region);
 
+        screen_info->wins_painted++;
         cw->skipped = FALSE;
     }
 
@@ -1351,10 +2076,7 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
      */
     for (list = g_list_last(screen_info->cwindows); list; list = g_list_previous (list))
     {
-        XserverRegion shadowClip;
-
         cw = (CWindow *) list->data;
-        shadowClip = None;
         TRACE ("painting backward 0x%lx", cw->id);
 
         if (cw->skipped)
@@ -1363,17 +2085,29 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
             continue;
         }
 
-        if (cw->shadow)
+        if (WIN_HAS_SHADOW(cw))
         {
-            shadowClip = XFixesCreateRegion(dpy, NULL, 0);
+            /* A single scratch region is used for all shadows */
+            if (shadowClip == None)
+            {
+                shadowClip = XFixesCreateRegion(dpy, NULL, 0);
+                screen_info->regions_created++;
+            }
             XFixesSubtractRegion (dpy, shadowClip, cw->borderClip, cw->borderSize);
 
             XFixesSetPictureClipRegion (dpy, screen_info->rootBuffer, 0, 0, shadowClip);
-            XRenderComposite (dpy, PictOpOver, screen_info->blackPicture, cw->shadow,
-                              screen_info->rootBuffer, 0, 0, 0, 0,
-                              cw->attr.x + cw->shadow_dx,
-                              cw->attr.y + cw->shadow_dy,
-                              cw->shadow_width, cw->shadow_height);
+            if (cw->shadow_tiles)
+            {
+                paint_shadow_tiles (cw, screen_info->rootBuffer);
+            }
+            else
+            {
+                XRenderComposite (dpy, PictOpOver, screen_info->blackPicture, cw->shadow,
+                                  screen_info->rootBuffer, 0, 0, 0, 0,
+                                  cw->attr.x + cw->shadow_dx,
+                                  cw->attr.y + cw->shadow_dy,
+                                  cw->shadow_width, cw->shadow_height);
+            }
         }
 
         if (cw->picture)
@@ -1390,18 +2124,14 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
             XFixesSetPictureClipRegion (dpy, screen_info->rootBuffer, 0, 0, cw->borderClip);
             paint_win (cw, paint_region, FALSE);
         }
+    }
 
-        if (shadowClip)
-        {
-            XFixesDestroyRegion (dpy, shadowClip);
-        }
-
-        if (cw->borderClip)
-        {
-            XFixesDestroyRegion (dpy, cw->borderClip);
-            cw->borderClip = None;
-        }
+    if (shadowClip)
+    {
+        XFixesDestroyRegion (dpy, shadowClip);
     }
+    TRACE ("%u window(s) painted, %u occluded, %u region(s) created",
+           screen_info->wins_painted, screen_info->wins_occluded, screen_info->regions_created);
 
     TRACE ("Copying data back to screen");
     /* Set clipping back to the given region */
@@ -1411,7 +2141,7 @@ paint_all (ScreenInfo *screen_info, XserverRegion region)
     XFixesDestroyRegion (dpy, paint_region);
 }
 
-#if TIMEOUT_REPAINT
+#if PACE_REPAINT
 static void
 remove_timeouts (ScreenInfo *screen_info)
 {
@@ -1421,12 +2151,169 @@ remove_timeouts (ScreenInfo *screen_info)
         screen_info->compositor_timeout_id = 0;
     }
 }
-#endif /* TIMEOUT_REPAINT */
+
+#if defined (HAVE_RANDR) && ((RANDR_MAJOR > 1) || (RANDR_MINOR >= 3))
+static gdouble
+get_mode_refresh_rate (XRRScreenResources *resources, RRMode mode)
+{
+    XRRModeInfo *mode_info;
+    gdouble v_total;
+    int i;
+
+    for (i = 0; i < resources->nmode; i++)
+    {
+        mode_info = &resources->modes[i];
+        if (mode_info->id != mode)
+        {
+            continue;
+        }
+        v_total = (gdouble) mode_info->vTotal;
+        if (mode_info->modeFlags & RR_DoubleScan)
+        {
+            v_total *= 2.0;
+        }
+        if (mode_info->modeFlags & RR_Interlace)
+        {
+            v_total /= 2.0;
+        }
+        if ((mode_info->hTotal > 0) && (v_total > 0.0))
+        {
+            return (gdouble) mode_info->dotClock / ((gdouble) mode_info->hTotal * v_total);
+        }
+        break;
+    }
+
+    return 0.0;
+}
+
+/*
+ * Exact refresh rate of the mode of the primary output, or of the
+ * first active CRTC. XRRConfigCurrentRate() only reports the rate of
+ * the RandR 1.1 screen configuration, which drivers often fake.
+ */
+static gint
+get_crtc_refresh_rate (ScreenInfo *screen_info)
+{
+    Display *dpy;
+    XRRScreenResources *resources;
+    XRROutputInfo *output_info;
+    XRRCrtcInfo *crtc_info;
+    RROutput primary;
+    RRCrtc crtc;
+    gdouble rate;
+    int major, minor;
+    int i;
+
+    dpy = myScreenGetXDisplay (screen_info);
+    if (!XRRQueryVersion (dpy, &major, &minor) || ((major == 1) && (minor < 3)))
+    {
+        return 0;
+    }
+
+    /* Current, so that this does not trigger a costly probe of the outputs */
+    resources = XRRGetScreenResourcesCurrent (dpy, screen_info->xroot);
+    if (!resources)
+    {
+        return 0;
+    }
+
+    crtc = None;
+    primary = XRRGetOutputPrimary (dpy, screen_info->xroot);
+    if (primary != None)
+    {
+        output_info = XRRGetOutputInfo (dpy, resources, primary);
+        if (output_info)
+        {
+            crtc = output_info->crtc;
+            XRRFreeOutputInfo (output_info);
+        }
+    }
+
+    rate = 0.0;
+    for (i = 0; (i < resources->ncrtc) && (rate <= 0.0); i++)
+    {
+        if ((crtc != None) && (resources->crtcs[i] != crtc))
+        {
+            continue;
+        }
+        crtc_info = XRRGetCrtcInfo (dpy, resources, resources->crtcs[i]);
+        if (crtc_info)
+        {
+            if (crtc_info->mode != None)
+            {
+                rate = get_mode_refresh_rate (resources, crtc_info->mode);
+            }
+            XRRFreeCrtcInfo (crtc_info);
+        }
+    }
+    XRRFreeScreenResources (resources);
+
+    return (gint) (rate + 0.5);
+}
+#endif /* HAVE_RANDR && RandR >= 1.3 */
+
+/* Only queried when the cached value was reset, on startup and on RandR changes */
+static gint
+get_refresh_rate (ScreenInfo *screen_info)
+{
+    gint rate;
+
+    rate = 0;
+#ifdef HAVE_RANDR
+#if (RANDR_MAJOR > 1) || (RANDR_MINOR >= 3)
+    if (screen_info->display_info->have_xrandr)
+    {
+        rate = get_crtc_refresh_rate (screen_info);
+    }
+#endif
+    if ((rate <= 0) && (screen_info->display_info->have_xrandr))
+    {
+        XRRScreenConfiguration *randr_info;
+
+        randr_info = XRRGetScreenInfo (screen_info->display_info->dpy, screen_info->xroot);
+        if (randr_info)
+        {
+            rate = (gint) XRRConfigCurrentRate (randr_info);
+            XRRFreeScreenConfigInfo (randr_info);
+        }
+    }
+#endif /* HAVE_RANDR */
+    if (rate <= 0)
+    {
+        rate = DEFAULT_REFRESH_RATE;
+    }
+    TRACE ("refresh rate for screen %i is %i Hz", screen_info->screen, rate);
+
+    return rate;
+}
+
+static gint64
+get_frame_interval (ScreenInfo *screen_info)
+{
+    gint rate;
+
+    if (screen_info->refresh_rate <= 0)
+    {
+        screen_info->refresh_rate = get_refresh_rate (screen_info);
+    }
+    rate = screen_info->refresh_rate;
+    if ((screen_info->params->max_fps > 0) && (screen_info->params->max_fps < rate))
+    {
+        rate = screen_info->params->max_fps;
+    }
+
+    return G_USEC_PER_SEC / rate;
+}
+#endif /* PACE_REPAINT */
 
 static void
 repair_screen (ScreenInfo *screen_info)
 {
     DisplayInfo *display_info;
+    gint64 start;
+#if PACE_REPAINT
+    gint64 now;
+#endif /* PACE_REPAINT */
 
     g_return_if_fail (screen_info);
     TRACE ("entering repair_screen");
@@ -1436,20 +2323,53 @@ repair_screen (ScreenInfo *screen_info)
         return;
     }
 
-#if TIMEOUT_REPAINT
+#if PACE_REPAINT
     remove_timeouts (screen_info);
-#endif /* TIMEOUT_REPAINT */
+#endif /* PACE_REPAINT */
 
     display_info = screen_info->display_info;
+    if (update_unredirect (screen_info))
+    {
+        XRectangle r;
+
+        /* The redirected window has to be painted along with everything else */
+        r.x = 0;
+        r.y = 0;
+        r.width = screen_info->width;
+        r.height = screen_info->height;
+        if (screen_info->allDamage != None)
+        {
+            XFixesDestroyRegion (display_info->dpy, screen_info->allDamage);
+        }
+        screen_info->allDamage = XFixesCreateRegion (display_info->dpy, &r, 1);
+    }
+
     if (screen_info->allDamage != None)
     {
+#if PACE_REPAINT
+        now = getCurrentTimeUsec ();
+        screen_info->frames_painted++;
+        /* Count the frames we could not start within the frame they were due */
+        if ((screen_info->next_repaint > 0) &&
+            (now - screen_info->next_repaint > get_frame_interval (screen_info)))
+        {
+            screen_info->frames_missed++;
+            TRACE ("repaint late by %li usec. (%u missed out of %u frames)",
+                   (long) (now - screen_info->next_repaint),
+                   screen_info->frames_missed, screen_info->frames_painted);
+        }
+        screen_info->last_repaint = now;
+        screen_info->next_repaint = 0;
+#endif /* PACE_REPAINT */
+        start = getCurrentTimeUsec ();
         paint_all (screen_info, screen_info->allDamage);
+        statsTime (STATS_PAINT, getCurrentTimeUsec () - start);
         XFixesDestroyRegion (display_info->dpy, screen_info->allDamage);
         screen_info->allDamage = None;
     }
 }
 
-#if TIMEOUT_REPAINT
+#if PACE_REPAINT
 static gboolean
 compositor_timeout_cb (gpointer data)
 {
@@ -1461,23 +2381,40 @@ compositor_timeout_cb (gpointer data)
 
     return FALSE;
 }
-#endif /* TIMEOUT_REPAINT */
+#endif /* PACE_REPAINT */
 
 static void
 add_repair (ScreenInfo *screen_info)
 {
-#if TIMEOUT_REPAINT
+#if PACE_REPAINT
+    gint64 now, target;
+
+    /* A repaint is already scheduled, the new damage will be painted with it */
     if (screen_info->compositor_timeout_id != 0)
     {
         return;
     }
+
+    /*
+     * Schedule the repaint for the next frame boundary, so that all the
+     * damage received until then is painted at once, and at most once
+     * per refresh of the display (or per max_fps).
+     */
+    now = getCurrentTimeUsec ();
+    target = screen_info->last_repaint + get_frame_interval (screen_info);
+    if ((target < now) || (screen_info->last_repaint > now))
+    {
+        target = now;
+    }
+    screen_info->next_repaint = target;
+    /* Round up, firing early would let the pace drift above the refresh rate */
     screen_info->compositor_timeout_id =
-        g_timeout_add (TIMEOUT_REPAINT,
+        g_timeout_add ((guint) ((target - now + 999) / 1000),
                        compositor_timeout_cb, screen_info);
-#endif /* TIMEOUT_REPAINT */
+#endif /* PACE_REPAINT */
 }
 
-#if TIMEOUT_REPAINT == 0
+#if PACE_REPAINT == 0
 static void
 repair_display (DisplayInfo *display_info)
 {
@@ -1609,6 +2546,11 @@ repair_win (CWindow *cw, XRectangle *r)
         fix_region (cw, parts);
         /* parts region will be destroyed by add_damage () */
         add_damage (cw->screen_info, parts);
+        if (!cw->damaged)
+        {
+            /* First damage, the window is now painted */
+            invalidate_occlusion (screen_info);
+        }
         cw->damaged = TRUE;
     }
 }
@@ -1655,6 +2597,7 @@ update_extents (CWindow *cw)
 
     screen_info = cw->screen_info;
     display_info = screen_info->display_info;
+    invalidate_occlusion (screen_info);
 
     if (WIN_IS_VISIBLE(cw))
     {
@@ -1679,6 +2622,7 @@ determine_mode (CWindow *cw)
     screen_info = cw->screen_info;
     display_info = screen_info->display_info;
     format = NULL;
+    invalidate_occlusion (screen_info);
 
     if (cw->alphaPict)
     {
@@ -1742,10 +2686,9 @@ set_win_opacity (CWindow *cw, guint opacity)
 
     cw->opacity = opacity;
     determine_mode(cw);
-    if (cw->shadow)
+    if (WIN_HAS_SHADOW(cw))
     {
-        XRenderFreePicture (display_info->dpy, cw->shadow);
-        cw->shadow = None;
+        free_win_shadow (cw);
         if (cw->extents)
         {
             XFixesDestroyRegion (display_info->dpy, cw->extents);
@@ -1766,6 +2709,7 @@ map_win (CWindow *cw)
 
     screen_info = cw->screen_info;
     display_info = screen_info->display_info;
+    invalidate_occlusion (screen_info);
 
     if (!WIN_IS_REDIRECTED(cw))
     {
@@ -1795,10 +2739,13 @@ map_win (CWindow *cw)
     cw->viewable = TRUE;
     cw->damaged = FALSE;
 
-    /* Check for new windows to un-redirect. */
+    /*
+     * Check for new windows to un-redirect over an unredirected fullscreen
+     * window, fullscreen windows themselves are unredirected on repaint.
+     */
     if (WIN_HAS_DAMAGE(cw) && WIN_IS_OVERRIDE(cw) &&
         WIN_IS_NATIVE_OPAQUE(cw) && WIN_IS_REDIRECTED(cw) && !WIN_IS_SHAPED(cw)
-        && ((screen_info->wins_unredirected > 0) || is_fullscreen(cw)))
+        && (screen_info->wins_unredirected > 0))
     {
         /* Make those opaque, we don't want them to be transparent */
         cw->opacity = NET_WM_OPAQUE;
@@ -1821,6 +2768,17 @@ unmap_win (CWindow *cw)
 
     screen_info = cw->screen_info;
     display_info = screen_info->display_info;
+    invalidate_occlusion (screen_info);
+
+    if (cw->id == screen_info->unredirect_win)
+    {
+        redirect_fullscreen (cw);
+    }
+    if (cw->id == screen_info->unredirect_candidate)
+    {
+        remove_unredirect_timeout (screen_info);
+        screen_info->unredirect_candidate = None;
+    }
 
     if (!WIN_IS_REDIRECTED(cw) && (screen_info->wins_unredirected > 0))
     {
@@ -1898,6 +2856,12 @@ add_win (DisplayInfo *display_info, Window id, Client *c)
 
     TRACE ("entering add_win: 0x%lx", id);
 
+    if (find_cwindow_in_display (display_info, id))
+    {
+        TRACE ("window 0x%lx already added", id);
+        return;
+    }
+
     new = g_new0 (CWindow, 1);
 
     myDisplayGrabServer (display_info);
@@ -1978,17 +2942,21 @@ add_win (DisplayInfo *display_info, Window id, Client *c)
     new->clientSize = None;
     new->extents = None;
     new->shadow = None;
+    new->shadow_tiles = NULL;
     new->shadow_dx = 0;
     new->shadow_dy = 0;
     new->shadow_width = 0;
     new->shadow_height = 0;
     new->borderClip = None;
+    new->occluded = FALSE;
 
     init_opacity (new);
     determine_mode (new);
 
     /* Insert window at top of stack */
     screen_info->cwindows = g_list_prepend (screen_info->cwindows, new);
+    invalidate_occlusion (screen_info);
+    g_hash_table_insert (display_info->cwindow_hash, (gpointer) id, new);
 
     if (WIN_IS_VISIBLE(new))
     {
@@ -2012,6 +2980,7 @@ restack_win (CWindow *cw, Window above)
     TRACE ("entering restack_win, 0x%lx above 0x%lx", cw->id, above);
 
     screen_info = cw->screen_info;
+    invalidate_occlusion (screen_info);
     sibling = g_list_find (screen_info->cwindows, (gconstpointer) cw);
     next = g_list_next (sibling);
     previous_above = None;
@@ -2066,6 +3035,7 @@ resize_win (CWindow *cw, gint x, gint y, gint width, gint height, gint bw)
     screen_info = cw->screen_info;
     display_info = screen_info->display_info;
     damage = None;
+    invalidate_occlusion (screen_info);
 
     if (WIN_IS_VISIBLE(cw))
     {
@@ -2097,11 +3067,7 @@ resize_win (CWindow *cw, gint x, gint y, gint width, gint height, gint bw)
             cw->picture = None;
         }
 
-        if (cw->shadow)
-        {
-            XRenderFreePicture (display_info->dpy, cw->shadow);
-            cw->shadow = None;
-        }
+        free_win_shadow (cw);
     }
 
     if ((cw->attr.width != width) || (cw->attr.height != height) ||
@@ -2149,6 +3115,7 @@ reshape_win (CWindow *cw)
 
     screen_info = cw->screen_info;
     display_info = screen_info->display_info;
+    invalidate_occlusion (screen_info);
 
     damage = None;
 
@@ -2167,11 +3134,7 @@ reshape_win (CWindow *cw)
         cw->extents = None;
     }
 
-    if (cw->shadow)
-    {
-        XRenderFreePicture (display_info->dpy, cw->shadow);
-        cw->shadow = None;
-    }
+    free_win_shadow (cw);
 
     if (cw->borderSize)
     {
@@ -2220,6 +3183,8 @@ destroy_win (DisplayInfo *display_info, Window id)
         }
         screen_info = cw->screen_info;
         screen_info->cwindows = g_list_remove (screen_info->cwindows, (gconstpointer) cw);
+        invalidate_occlusion (screen_info);
+        g_hash_table_remove (display_info->cwindow_hash, (gconstpointer) cw->id);
 
         free_win_data (cw, TRUE);
     }
@@ -2753,9 +3718,9 @@ compositorHandleEvent (DisplayInfo *display_info, XEvent *ev)
     {
         compositorHandleShapeNotify (display_info, (XShapeEvent *) ev);
     }
-#if TIMEOUT_REPAINT == 0
+#if PACE_REPAINT == 0
     repair_display (display_info);
-#endif /* TIMEOUT_REPAINT */
+#endif /* PACE_REPAINT */
 
 #endif /* HAVE_COMPOSITOR */
 }
@@ -2835,6 +3800,7 @@ compositorInitDisplay (DisplayInfo *display_info)
     }
 
     display_info->composite_mode = 0;
+    display_info->cwindow_hash = g_hash_table_new (g_direct_hash, g_direct_equal);
 #if HAVE_NAME_WINDOW_PIXMAP
     display_info->have_name_window_pixmap = ((composite_major > 0) || (composite_minor >= 2));
 #else  /* HAVE_NAME_WINDOW_PIXMAP */
@@ -2884,6 +3850,7 @@ compositorManageScreen (ScreenInfo *screen_info)
 
     gdk_error_trap_push ();
     XCompositeRedirectSubwindows (display_info->dpy, screen_info->xroot, display_info->composite_mode);
+    statsCount (STATS_XSYNC);
     XSync (display_info->dpy, FALSE);
 
     if (gdk_error_trap_pop ())
@@ -2961,11 +3928,28 @@ compositorManageScreen (ScreenInfo *screen_info)
                                                0.0  /* blue  */);
     screen_info->rootTile = None;
     screen_info->allDamage = None;
+    screen_info->shadow_cache = NULL;
+    screen_info->shadow_tiles = NULL;
     screen_info->cwindows = NULL;
+    screen_info->occlusion_valid = FALSE;
+    screen_info->unredirect_win = None;
+    screen_info->unredirect_candidate = None;
+    screen_info->unredirect_timeout_id = 0;
+    screen_info->unredirect_start = 0;
+    screen_info->unredirect_time = 0;
+    screen_info->unredirect_count = 0;
+    screen_info->wins_painted = 0;
+    screen_info->wins_occluded = 0;
+    screen_info->regions_created = 0;
     screen_info->compositor_active = TRUE;
     screen_info->wins_unredirected = 0;
     screen_info->compositor_timeout_id = 0;
     screen_info->damages_pending = FALSE;
+    screen_info->refresh_rate = 0;
+    screen_info->last_repaint = 0;
+    screen_info->next_repaint = 0;
+    screen_info->frames_painted = 0;
+    screen_info->frames_missed = 0;
 
     XClearArea (display_info->dpy, screen_info->output, 0, 0, 0, 0, TRUE);
     compositorSetCMSelection (screen_info, screen_info->xfwm4_win);
@@ -3001,14 +3985,22 @@ compositorUnmanageScreen (ScreenInfo *screen_info)
     }
     screen_info->compositor_active = FALSE;
 
-#if TIMEOUT_REPAINT
+#if PACE_REPAINT
     remove_timeouts (screen_info);
-#endif /* TIMEOUT_REPAINT */
+#endif /* PACE_REPAINT */
+    remove_unredirect_timeout (screen_info);
+    if (screen_info->unredirect_win != None)
+    {
+        screen_info->unredirect_time += getCurrentTimeUsec () - screen_info->unredirect_start;
+        screen_info->unredirect_win = None;
+    }
+    screen_info->unredirect_candidate = None;
 
     i = 0;
     for (list = screen_info->cwindows; list; list = g_list_next (list))
     {
         CWindow *cw2 = (CWindow *) list->data;
+        g_hash_table_remove (display_info->cwindow_hash, (gconstpointer) cw2->id);
         free_win_data (cw2, TRUE);
         i++;
     }
@@ -3016,6 +4008,8 @@ compositorUnmanageScreen (ScreenInfo *screen_info)
     screen_info->cwindows = NULL;
     TRACE ("Compositor: removed %i window(s) remaining", i);
 
+    free_shadow_cache (screen_info);
+
 #if HAVE_OVERLAYS
     if (display_info->have_overlays)
     {
@@ -3059,6 +4053,10 @@ compositorUnmanageScreen (ScreenInfo *screen_info)
     screen_info->gaussianSize = -1;
     screen_info->wins_unredirected = 0;
 
+    DBG ("Compositor: %u frame(s) painted, %u missed", screen_info->frames_painted, screen_info->frames_missed);
+    DBG ("Compositor: %u fullscreen unredirection(s), %li ms unredirected",
+         screen_info->unredirect_count, (long) (screen_info->unredirect_time / 1000));
+
     XCompositeUnredirectSubwindows (display_info->dpy, screen_info->xroot,
                                     display_info->composite_mode);
 
@@ -3162,10 +4160,30 @@ compositorUpdateScreenSize (ScreenInfo *screen_info)
         XRenderFreePicture (display_info->dpy, screen_info->rootBuffer);
         screen_info->rootBuffer = None;
     }
+    /* Screen size changes usually come with a mode change */
+    screen_info->refresh_rate = 0;
+    invalidate_occlusion (screen_info);
     damage_screen (screen_info);
 #endif /* HAVE_COMPOSITOR */
 }
 
+void
+compositorUpdateRefreshRate (ScreenInfo *screen_info)
+{
+#ifdef HAVE_COMPOSITOR
+    g_return_if_fail (screen_info != NULL);
+    TRACE ("entering compositorUpdateRefreshRate");
+
+    if (!compositorIsUsable (screen_info->display_info))
+    {
+        return;
+    }
+
+    /* Will be queried again from XRandR on next repaint */
+    screen_info->refresh_rate = 0;
+#endif /* HAVE_COMPOSITOR */
+}
+
 void
 compositorWindowSetOpacity (DisplayInfo *display_info, Window id, guint opacity)
 {
@@ -3211,6 +4229,7 @@ compositorRebuildScreen (ScreenInfo *screen_info)
         free_win_data (cw2, FALSE);
         init_opacity (cw2);
     }
+    invalidate_occlusion (screen_info);
     damage_screen (screen_info);
 #endif /* HAVE_COMPOSITOR */
 }
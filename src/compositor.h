@@ -63,6 +63,7 @@ void                     compositorAddAllWindows                (ScreenInfo *);
 gboolean                 compositorActivateScreen               (ScreenInfo *,
                                                                  gboolean);
 void                     compositorUpdateScreenSize             (ScreenInfo *);
+void                     compositorUpdateRefreshRate            (ScreenInfo *);
 
 void                     compositorWindowSetOpacity             (DisplayInfo *,
                                                                  Window,
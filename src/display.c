@@ -42,7 +42,9 @@
 #include "display.h"
 #include "screen.h"
 #include "client.h"
+#include "hints.h"
 #include "compositor.h"
+#include "misc.h"
 
 #ifndef MAX_HOSTNAME_LENGTH
 #define MAX_HOSTNAME_LENGTH 32
@@ -56,6 +58,13 @@
 #define CURSOR_MOVE XC_fleur
 #endif
 
+typedef struct _ClientWindow ClientWindow;
+struct _ClientWindow
+{
+    Client *c;
+    unsigned short mode;
+};
+
 static int
 handleXError (Display * dpy, XErrorEvent * err)
 {
@@ -167,6 +176,7 @@ myDisplayInitAtoms (DisplayInfo *display_info)
         "WM_TRANSIENT_FOR",
         "WM_WINDOW_ROLE",
         "XFWM4_COMPOSITING_MANAGER",
+        "XFWM4_STATS",
         "XFWM4_TIMESTAMP_PROP",
         "_XROOTPMAP_ID",
         "_XSETROOT_ID"
@@ -203,6 +213,7 @@ myDisplayInit (GdkDisplay *gdisplay)
 
     display->gdisplay = gdisplay;
     display->dpy = (Display *) gdk_x11_display_get_xdisplay (gdisplay);
+    display->xcb = XGetXCBConnection (display->dpy);
 
     display->session = NULL;
     display->quit = FALSE;
@@ -307,6 +318,13 @@ myDisplayInit (GdkDisplay *gdisplay)
     display->xfilter = NULL;
     display->screens = NULL;
     display->clients = NULL;
+    display->client_windows = g_hash_table_new (g_direct_hash, g_direct_equal);
+#ifdef HAVE_XSYNC
+    display->xsync_alarms = g_hash_table_new (g_direct_hash, g_direct_equal);
+#endif /* HAVE_XSYNC */
+    display->pending_clients = NULL;
+    display->pending_idle_id = 0;
+    display->property_prefetch = g_hash_table_new (g_direct_hash, g_direct_equal);
     display->xgrabcount = 0;
     display->double_click_time = 250;
     display->double_click_distance = 5;
@@ -325,6 +343,17 @@ myDisplayInit (GdkDisplay *gdisplay)
     return display;
 }
 
+static void
+myDisplayFreeClientWindows (gpointer key, gpointer value, gpointer user_data)
+{
+    GSList *list;
+
+    for (list = (GSList *) value; list; list = g_slist_next (list))
+    {
+        g_free (list->data);
+    }
+}
+
 DisplayInfo *
 myDisplayClose (DisplayInfo *display)
 {
@@ -341,9 +370,38 @@ myDisplayClose (DisplayInfo *display)
     g_slist_free (display->clients);
     display->clients = NULL;
 
+    if (display->pending_idle_id)
+    {
+        g_source_remove (display->pending_idle_id);
+        display->pending_idle_id = 0;
+    }
+    g_slist_free (display->pending_clients);
+    display->pending_clients = NULL;
+
+    discardAllPrefetchedProperties (display);
+    multimapDestroy (display->property_prefetch);
+    display->property_prefetch = NULL;
+
+    g_hash_table_foreach (display->client_windows, myDisplayFreeClientWindows, NULL);
+    multimapDestroy (display->client_windows);
+    display->client_windows = NULL;
+
+#ifdef HAVE_XSYNC
+    g_hash_table_destroy (display->xsync_alarms);
+    display->xsync_alarms = NULL;
+#endif /* HAVE_XSYNC */
+
     g_slist_free (display->screens);
     display->screens = NULL;
 
+#ifdef HAVE_COMPOSITOR
+    if (display->cwindow_hash)
+    {
+        g_hash_table_destroy (display->cwindow_hash);
+        display->cwindow_hash = NULL;
+    }
+#endif /* HAVE_COMPOSITOR */
+
     return display;
 }
 
@@ -489,19 +547,116 @@ myDisplayUngrabServer (DisplayInfo *display)
 void
 myDisplayAddClient (DisplayInfo *display, Client *c)
 {
+    int b;
+
     g_return_if_fail (c != None);
     g_return_if_fail (display != NULL);
 
     display->clients = g_slist_append (display->clients, c);
+
+    myDisplayAddClientWindow (display, c->window, c, SEARCH_WINDOW);
+    myDisplayAddClientWindow (display, c->frame, c, SEARCH_FRAME);
+    myDisplayAddClientWindow (display, c->user_time_win, c, SEARCH_WIN_USER_TIME);
+    for (b = 0; b < BUTTON_COUNT; b++)
+    {
+        myDisplayAddClientWindow (display, MYWINDOW_XWINDOW (c->buttons[b]), c, SEARCH_BUTTON);
+    }
+#ifdef HAVE_XSYNC
+    if (c->xsync_alarm != None)
+    {
+        g_hash_table_insert (display->xsync_alarms, (gpointer) c->xsync_alarm, c);
+    }
+#endif /* HAVE_XSYNC */
 }
 
 void
 myDisplayRemoveClient (DisplayInfo *display, Client *c)
 {
+    int b;
+
     g_return_if_fail (c != None);
     g_return_if_fail (display != NULL);
 
     display->clients = g_slist_remove (display->clients, c);
+
+    myDisplayRemoveClientWindow (display, c->window, c, SEARCH_WINDOW);
+    myDisplayRemoveClientWindow (display, c->frame, c, SEARCH_FRAME);
+    myDisplayRemoveClientWindow (display, c->user_time_win, c, SEARCH_WIN_USER_TIME);
+    for (b = 0; b < BUTTON_COUNT; b++)
+    {
+        myDisplayRemoveClientWindow (display, MYWINDOW_XWINDOW (c->buttons[b]), c, SEARCH_BUTTON);
+    }
+#ifdef HAVE_XSYNC
+    if (c->xsync_alarm != None)
+    {
+        g_hash_table_remove (display->xsync_alarms, (gconstpointer) c->xsync_alarm);
+    }
+#endif /* HAVE_XSYNC */
+}
+
+void
+myDisplayAddClientWindow (DisplayInfo *display, Window w, Client *c, unsigned short mode)
+{
+    ClientWindow *cwin;
+    GSList *list;
+
+    g_return_if_fail (c != NULL);
+    g_return_if_fail (display != NULL);
+
+    if (w == None)
+    {
+        return;
+    }
+
+    /*
+     * The same X window may be known under several search modes (the
+     * user time window is usually the client window itself), or even
+     * for several clients, so each key holds a short list of entries.
+     */
+    for (list = multimapLookup (display->client_windows, (gconstpointer) w); list; list = g_slist_next (list))
+    {
+        cwin = (ClientWindow *) list->data;
+        if (cwin->c == c)
+        {
+            cwin->mode |= mode;
+            return;
+        }
+    }
+
+    cwin = g_new0 (ClientWindow, 1);
+    cwin->c = c;
+    cwin->mode = mode;
+    multimapInsert (display->client_windows, (gpointer) w, cwin);
+}
+
+void
+myDisplayRemoveClientWindow (DisplayInfo *display, Window w, Client *c, unsigned short mode)
+{
+    ClientWindow *cwin;
+    GSList *list;
+
+    g_return_if_fail (c != NULL);
+    g_return_if_fail (display != NULL);
+
+    if (w == None)
+    {
+        return;
+    }
+
+    for (list = multimapLookup (display->client_windows, (gconstpointer) w); list; list = g_slist_next (list))
+    {
+        cwin = (ClientWindow *) list->data;
+        if (cwin->c == c)
+        {
+            cwin->mode &= ~mode;
+            if (cwin->mode == 0)
+            {
+                multimapRemove (display->client_windows, (gpointer) w, cwin);
+                g_free (cwin);
+            }
+            break;
+        }
+    }
 }
 
 Client *
@@ -512,12 +667,13 @@ myDisplayGetClientFromWindow (DisplayInfo *display, Window w, unsigned short mod
     g_return_val_if_fail (w != None, NULL);
     g_return_val_if_fail (display != NULL, NULL);
 
-    for (list = display->clients; list; list = g_slist_next (list))
+    for (list = multimapLookup (display->client_windows, (gconstpointer) w); list; list = g_slist_next (list))
     {
-        Client *c = (Client *) list->data;
-        if (clientGetFromWindow (c, w, mode))
+        ClientWindow *cwin = (ClientWindow *) list->data;
+        if (cwin->mode & mode)
         {
-            return (c);
+            TRACE ("found \"%s\" (mode 0x%x)", cwin->c->name, cwin->mode & mode);
+            return (cwin->c);
         }
     }
     TRACE ("no client found");
@@ -651,22 +807,18 @@ myDisplayGetScreenFromSystray (DisplayInfo *display, Window w)
 Client *
 myDisplayGetClientFromXSyncAlarm (DisplayInfo *display, XSyncAlarm xalarm)
 {
-    GSList *list;
+    Client *c;
 
     g_return_val_if_fail (xalarm != None, NULL);
     g_return_val_if_fail (display != NULL, NULL);
 
-    for (list = display->clients; list; list = g_slist_next (list))
+    c = (Client *) g_hash_table_lookup (display->xsync_alarms, (gconstpointer) xalarm);
+    if (c == NULL)
     {
-        Client *c = (Client *) list->data;
-        if (xalarm == c->xsync_alarm)
-        {
-            return (c);
-        }
+        TRACE ("no client found");
     }
-    TRACE ("no client found");
 
-    return NULL;
+    return c;
 }
 #endif /* HAVE_XSYNC */
 
@@ -32,6 +32,7 @@
 #include <X11/Xutil.h>
 #include <X11/cursorfont.h>
 #include <X11/extensions/shape.h>
+#include <X11/Xlib-xcb.h>
 
 #ifndef ShapeInput
 #define ShapeInput 2
@@ -262,6 +263,7 @@ enum
     WM_TRANSIENT_FOR,
     WM_WINDOW_ROLE,
     XFWM4_COMPOSITING_MANAGER,
+    XFWM4_STATS,
     XFWM4_TIMESTAMP_PROP,
     XROOTPMAP,
     XSETROOT,
@@ -280,6 +282,7 @@ struct _DisplayInfo
 {
     GdkDisplay *gdisplay;
     Display *dpy;
+    xcb_connection_t *xcb;
 
     XfceSMClient *session;
     gboolean quit;
@@ -296,6 +299,13 @@ struct _DisplayInfo
     eventFilterSetup *xfilter;
     GSList *screens;
     GSList *clients;
+    GHashTable *client_windows;
+#ifdef HAVE_XSYNC
+    GHashTable *xsync_alarms;
+#endif /* HAVE_XSYNC */
+    GSList *pending_clients;
+    guint pending_idle_id;
+    GHashTable *property_prefetch;
 
     gboolean have_shape;
     gboolean have_render;
@@ -334,6 +344,8 @@ struct _DisplayInfo
     gint fixes_event_base;
     gint composite_mode;
 
+    GHashTable *cwindow_hash;
+
     gboolean have_composite;
     gboolean have_damage;
     gboolean have_fixes;
@@ -367,6 +379,14 @@ void                     myDisplayAddClient                     (DisplayInfo *,
                                                                  Client *);
 void                     myDisplayRemoveClient                  (DisplayInfo *,
                                                                  Client *);
+void                     myDisplayAddClientWindow               (DisplayInfo *,
+                                                                 Window,
+                                                                 Client *,
+                                                                 unsigned short);
+void                     myDisplayRemoveClientWindow            (DisplayInfo *,
+                                                                 Window,
+                                                                 Client *,
+                                                                 unsigned short);
 Client                  *myDisplayGetClientFromWindow           (DisplayInfo *,
                                                                  Window,
                                                                  unsigned short);
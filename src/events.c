@@ -64,6 +64,7 @@
 #include "event_filter.h"
 #include "xsync.h"
 #include "display.h"
+#include "stats.h"
 
 #ifndef CHECK_BUTTON_TIME
 #define CHECK_BUTTON_TIME 0
@@ -1755,6 +1756,8 @@ handlePropertyNotify (DisplayInfo *display_info, XPropertyEvent * ev)
     eventFilterStatus status;
     ScreenInfo *screen_info;
     Client *c;
+    gboolean had_icon_hints;
+    gboolean has_icon_hints;
 
     TRACE ("entering handlePropertyNotify");
 
@@ -1774,7 +1777,7 @@ handlePropertyNotify (DisplayInfo *display_info, XPropertyEvent * ev)
                  (ev->atom == display_info->atoms[WM_CLIENT_MACHINE]))
         {
             TRACE ("client \"%s\" (0x%lx) has received a XA_WM_NAME/NET_WM_NAME/WM_CLIENT_MACHINE notify", c->name, c->window);
-            clientUpdateName (c);
+            clientQueuePropertyUpdate (c, PENDING_PROPERTY_NAME);
         }
         else if (ev->atom == display_info->atoms[MOTIF_WM_HINTS])
         {
@@ -1786,17 +1789,36 @@ handlePropertyNotify (DisplayInfo *display_info, XPropertyEvent * ev)
             TRACE ("client \"%s\" (0x%lx) has received a XA_WM_HINTS notify", c->name, c->window);
 
             /* Free previous wmhints if any */
+            had_icon_hints = FALSE;
             if (c->wmhints)
             {
+                had_icon_hints = ((c->wmhints->flags & (IconPixmapHint | IconMaskHint)) != 0);
                 XFree (c->wmhints);
             }
 
-            c->wmhints = XGetWMHints (display_info->dpy, c->window);
+            c->wmhints = getWMHints (display_info, c->window);
+            has_icon_hints = ((c->wmhints) && (c->wmhints->flags & (IconPixmapHint | IconMaskHint)));
+
+            /*
+             * Apps may redraw the same icon pixmap and set the hints again,
+             * so drop the cached icons unless neither the old nor the new
+             * hints carry an icon, as with urgency-only changes.
+             */
+            if ((has_icon_hints) || (had_icon_hints) || (c->wmhints == NULL))
+            {
+                clientInvalidateIcon (c);
+                if ((!has_icon_hints) && (had_icon_hints) && (screen_info->params->show_app_icon))
+                {
+                    clientUpdateIcon (c);
+                }
+            }
+
             if (c->wmhints)
             {
                 if (c->wmhints->flags & WindowGroupHint)
                 {
                     c->group_leader = c->wmhints->window_group;
+                    clientTransientsUpdate (c);
                 }
                 if ((c->wmhints->flags & IconPixmapHint) && (screen_info->params->show_app_icon))
                 {
@@ -1859,7 +1881,7 @@ handlePropertyNotify (DisplayInfo *display_info, XPropertyEvent * ev)
         else if (ev->atom == display_info->atoms[NET_WM_USER_TIME])
         {
             TRACE ("client \"%s\" (0x%lx) has received a NET_WM_USER_TIME notify", c->name, c->window);
-            clientGetUserTime (c);
+            clientQueuePropertyUpdate (c, PENDING_PROPERTY_USER_TIME);
         }
         else if (ev->atom == display_info->atoms[NET_WM_USER_TIME_WINDOW])
         {
@@ -1897,11 +1919,15 @@ handlePropertyNotify (DisplayInfo *display_info, XPropertyEvent * ev)
                 FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_OPACITY_LOCKED);
             }
         }
-        else if ((screen_info->params->show_app_icon) &&
-                 ((ev->atom == display_info->atoms[NET_WM_ICON]) ||
-                  (ev->atom == display_info->atoms[KWM_WIN_ICON])))
+        else if ((ev->atom == display_info->atoms[NET_WM_ICON]) ||
+                 (ev->atom == display_info->atoms[KWM_WIN_ICON]))
         {
-            clientUpdateIcon (c);
+            /* The cached icons are also used by the tabwin */
+            clientInvalidateIcon (c);
+            if (screen_info->params->show_app_icon)
+            {
+                clientUpdateIcon (c);
+            }
         }
 #ifdef HAVE_STARTUP_NOTIFICATION
         else if (ev->atom == display_info->atoms[NET_STARTUP_ID])
@@ -2215,9 +2241,9 @@ handleXSyncAlarmNotify (DisplayInfo *display_info, XSyncAlarmNotifyEvent * ev)
     c = myDisplayGetClientFromXSyncAlarm (display_info, ev->alarm);
     if (c)
     {
-        c->xsync_waiting = FALSE;
-        c->xsync_value = ev->counter_value;
-        clientXSyncClearTimeout (c);
+        clientXSyncUpdate (c, ev->counter_value);
+        /* Send the size the window was resized to meanwhile, if any */
+        clientResizeConfigurePending (c);
     }
 
     return EVENT_FILTER_REMOVE;
@@ -2235,6 +2261,18 @@ handleEvent (DisplayInfo *display_info, XEvent * ev)
     /* Update the display time */
     myDisplayUpdateCurrentTime (display_info, ev);
     sn_process_event (ev);
+
+    /*
+     * Focus and stacking decisions rely on the name and user time, the
+     * other events leave the queued properties to the idle callback.
+     */
+    if ((ev->type == ButtonPress) || (ev->type == KeyPress) ||
+        (ev->type == FocusIn) || (ev->type == MapRequest) ||
+        (ev->type == ClientMessage))
+    {
+        clientFlushPendingProperties (display_info);
+    }
+
     switch (ev->type)
     {
         case MotionNotify:
@@ -2338,11 +2376,19 @@ xfwm4_event_filter (XEvent * xevent, gpointer data)
 {
     eventFilterStatus status;
     DisplayInfo *display_info;
+    gint64 start;
 
     display_info = (DisplayInfo *) data;
 
     TRACE ("entering xfwm4_event_filter");
+    start = getCurrentTimeUsec ();
     status = handleEvent (display_info, xevent);
+    /* Do not count the notifications of our own counters */
+    if ((xevent->type != PropertyNotify) ||
+        (xevent->xproperty.atom != display_info->atoms[XFWM4_STATS]))
+    {
+        statsEvent (xevent->type, getCurrentTimeUsec () - start);
+    }
     TRACE ("leaving xfwm4_event_filter");
     return EVENT_FILTER_STOP | status;
 }
@@ -2870,6 +2916,11 @@ monitors_changed_cb(GdkScreen *gscreen, gpointer data)
     {
         compositorUpdateScreenSize (screen_info);
     }
+    else
+    {
+        /* The monitors may have switched to a different refresh rate */
+        compositorUpdateRefreshRate (screen_info);
+    }
 
     clientScreenResize (screen_info, (screen_info->num_monitors < previous_num_monitors));
 }
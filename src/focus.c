@@ -43,6 +43,7 @@
 #include "client.h"
 #include "frame.h"
 #include "stacking.h"
+#include "stats.h"
 #include "transients.h"
 #include "workspaces.h"
 #include "hints.h"
@@ -76,6 +77,14 @@ clientDumpList (ScreenInfo *screen_info)
 }
 #endif
 
+static gboolean
+clientIsFocusableNotExcluded (Client *c, gconstpointer exclude_list)
+{
+    return (clientAcceptFocus (c)
+            && !(c->type & WINDOW_TYPE_DONT_FOCUS)
+            && !g_list_find ((GList *) exclude_list, (gconstpointer) c));
+}
+
 static ClientPair
 clientGetTopMostFocusable (ScreenInfo *screen_info, guint layer, GList * exclude_list)
 {
@@ -86,29 +95,40 @@ clientGetTopMostFocusable (ScreenInfo *screen_info, guint layer, GList * exclude
     TRACE ("entering clientGetTopMostFocusable");
 
     top_client.prefered = top_client.highest = NULL;
-    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+
+    /*
+     * Start just below the first focusable window above the given
+     * layer, and go down until a prefered window is found.
+     */
+    c = clientGetFirstInLayers (screen_info, layer + 1, clientIsFocusableNotExcluded, exclude_list);
+    if (c)
+    {
+        list = g_list_previous (clientGetStackLink (c));
+    }
+    else
+    {
+        list = clientGetStackTop (screen_info);
+    }
+
+    for (; list && !top_client.prefered; list = g_list_previous (list))
     {
         c = (Client *) list->data;
         TRACE ("*** stack window \"%s\" (0x%lx), layer %i", c->name,
             c->window, (int) c->win_layer);
 
-        if (!clientAcceptFocus (c) || (c->type & WINDOW_TYPE_DONT_FOCUS))
+        if (!clientIsFocusableNotExcluded (c, exclude_list))
         {
             continue;
         }
 
-        if (!g_list_find (exclude_list, (gconstpointer) c))
+        if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_VISIBLE))
         {
-            if (c->win_layer > layer)
+            if (clientSelectMask (c, NULL, 0, WINDOW_REGULAR_FOCUSABLE))
             {
-                break;
+                top_client.prefered = c;
             }
-            else if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_VISIBLE))
+            if (!top_client.highest)
             {
-                if (clientSelectMask (c, NULL, 0, WINDOW_REGULAR_FOCUSABLE))
-                {
-                    top_client.prefered = c;
-                }
                 top_client.highest = c;
             }
         }
@@ -365,10 +385,13 @@ clientPassFocus (ScreenInfo *screen_info, Client *c, GList *exclude_list)
     display_info = screen_info->display_info;
     top_most = clientGetTopMostFocusable (screen_info, look_in_layer, exclude_list);
 
-    if (!(screen_info->params->click_to_focus) &&
-        XQueryPointer (myScreenGetXDisplay (screen_info), screen_info->xroot, &dr, &window, &rx, &ry, &wx, &wy, &mask))
+    if (!(screen_info->params->click_to_focus))
     {
-        new_focus = clientAtPosition (screen_info, rx, ry, exclude_list);
+        statsCount (STATS_QUERY_POINTER);
+        if (XQueryPointer (myScreenGetXDisplay (screen_info), screen_info->xroot, &dr, &window, &rx, &ry, &wx, &wy, &mask))
+        {
+            new_focus = clientAtPosition (screen_info, rx, ry, exclude_list);
+        }
     }
     if (!new_focus)
     {
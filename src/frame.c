@@ -339,8 +339,13 @@ frameCreateTitlePixmap (Client * c, int state, int left, int right, xfwmPixmap *
         voffset = screen_info->params->title_vertical_offset_inactive;
     }
 
-    layout = gtk_widget_create_pango_layout (myScreenGetGtkWidget (screen_info), c->name);
-    pango_layout_set_auto_dir (layout, FALSE);
+    /* The layout only depends on the name and font, keep it around */
+    if (!c->title_layout)
+    {
+        c->title_layout = gtk_widget_create_pango_layout (myScreenGetGtkWidget (screen_info), c->name);
+        pango_layout_set_auto_dir (c->title_layout, FALSE);
+    }
+    layout = c->title_layout;
     pango_layout_get_pixel_extents (layout, NULL, &logical_rect);
 
     title_height = screen_info->font_height;
@@ -484,7 +489,82 @@ frameCreateTitlePixmap (Client * c, int state, int left, int right, xfwmPixmap *
     }
     g_object_unref (G_OBJECT (gc));
     g_object_unref (G_OBJECT (gpixmap));
-    g_object_unref (G_OBJECT (layout));
+}
+
+static TitleCache *
+frameGetTitlePixmap (Client * c, int state, int left, int right)
+{
+    TitleCache *cache;
+    gint width, height, top_left, top_right;
+
+    TRACE ("entering frameGetTitlePixmap");
+
+    cache = &c->title_cache[(state == ACTIVE) ? 0 : 1];
+    width = frameWidth (c);
+    height = frameTop (c);
+    top_left = frameTopLeftWidth (c, state);
+    top_right = frameTopRightWidth (c, state);
+
+    if ((cache->valid) &&
+        (cache->width == width) && (cache->height == height) &&
+        (cache->top_left == top_left) && (cache->top_right == top_right) &&
+        (cache->left == left) && (cache->right == right))
+    {
+        TRACE ("reusing cached title for \"%s\" (0x%lx)", c->name, c->window);
+        return cache;
+    }
+
+    xfwmPixmapFree (&cache->pm_title);
+    xfwmPixmapFree (&cache->pm_top);
+    frameCreateTitlePixmap (c, state, left, right, &cache->pm_title, &cache->pm_top);
+
+    cache->width = width;
+    cache->height = height;
+    cache->top_left = top_left;
+    cache->top_right = top_right;
+    cache->left = left;
+    cache->right = right;
+    cache->valid = TRUE;
+
+    return cache;
+}
+
+void
+frameInitTitleCache (Client * c)
+{
+    guint i;
+
+    g_return_if_fail (c != NULL);
+
+    for (i = 0; i < 2; i++)
+    {
+        xfwmPixmapInit (c->screen_info, &c->title_cache[i].pm_title);
+        xfwmPixmapInit (c->screen_info, &c->title_cache[i].pm_top);
+        c->title_cache[i].valid = FALSE;
+    }
+    c->title_layout = NULL;
+}
+
+void
+frameClearTitleCache (Client * c)
+{
+    guint i;
+
+    g_return_if_fail (c != NULL);
+
+    TRACE ("entering frameClearTitleCache");
+
+    for (i = 0; i < 2; i++)
+    {
+        xfwmPixmapFree (&c->title_cache[i].pm_title);
+        xfwmPixmapFree (&c->title_cache[i].pm_top);
+        c->title_cache[i].valid = FALSE;
+    }
+    if (c->title_layout)
+    {
+        g_object_unref (G_OBJECT (c->title_layout));
+        c->title_layout = NULL;
+    }
 }
 
 static int
@@ -588,56 +668,230 @@ getLetterFromButton (int i, Client * c)
     return chr;
 }
 
-static void
-frameSetShape (Client * c, int state, FramePixmap * frame_pix, int button_x[BUTTON_COUNT])
+static gboolean
+frameCornerCut (Client * c, int state, int corner, XRectangle * rect)
 {
     ScreenInfo *screen_info;
-    DisplayInfo *display_info;
-    XRectangle rect;
-    xfwmPixmap *my_pixmap;
-    int i;
-
-    TRACE ("entering frameSetShape");
-    TRACE ("setting shape for client (0x%lx)", c->window);
+    int limit;
 
     screen_info = c->screen_info;
-    display_info = screen_info->display_info;
 
-    if (!display_info->have_shape)
+    /* Keep the corners of short windows from overlapping */
+    switch (corner)
     {
-        return;
+        case CORNER_TOP_LEFT:
+        case CORNER_TOP_RIGHT:
+            limit = frameHeight (c) - frameBottom (c) + 1;
+            if (screen_info->corners[corner][state].height <= limit)
+            {
+                return FALSE;
+            }
+            rect->x      = 0;
+            rect->y      = limit;
+            rect->width  = (corner == CORNER_TOP_LEFT) ?
+                               frameTopLeftWidth (c, state) : frameTopRightWidth (c, state);
+            rect->height = screen_info->corners[corner][state].height - limit;
+            return TRUE;
+        case CORNER_BOTTOM_LEFT:
+        case CORNER_BOTTOM_RIGHT:
+            limit = frameHeight (c) - frameTop (c) + 1;
+            if (screen_info->corners[corner][state].height <= limit)
+            {
+                return FALSE;
+            }
+            rect->x      = 0;
+            rect->y      = 0;
+            rect->width  = screen_info->corners[corner][state].width;
+            rect->height = screen_info->corners[corner][state].height - limit;
+            return TRUE;
+        default:
+            break;
     }
 
-    if (screen_info->shape_win == None)
+    return FALSE;
+}
+
+static gboolean
+frameShapeAddPiece (GdkRegion * shape, xfwmPixmap * pm, XRectangle * cut, int x, int y)
+{
+    GdkRegion *piece;
+    GdkRegion *cut_region;
+    GdkRectangle rect;
+
+    if ((pm->pixmap == None) || (!pm->shape))
     {
-        screen_info->shape_win = XCreateSimpleWindow (display_info->dpy, screen_info->xroot, 0, 0, frameWidth (c), frameHeight (c), 0, 0, 0);
+        return FALSE;
     }
-    else
+
+    piece = gdk_region_copy (pm->shape);
+    if (cut)
     {
-        XResizeWindow (display_info->dpy, screen_info->shape_win, frameWidth (c), frameHeight (c));
+        rect.x = cut->x;
+        rect.y = cut->y;
+        rect.width = cut->width;
+        rect.height = cut->height;
+        cut_region = gdk_region_rectangle (&rect);
+        gdk_region_subtract (piece, cut_region);
+        gdk_region_destroy (cut_region);
     }
+    gdk_region_offset (piece, x, y);
+    gdk_region_union (shape, piece);
+    gdk_region_destroy (piece);
 
-    if (FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
+    return TRUE;
+}
+
+/*
+ * Computes the frame shape from the masks of the theme parts kept on
+ * the client side, or returns NULL when it has to be done by the server
+ * (shaped client windows, or parts whose mask is not known).
+ */
+static GdkRegion *
+frameComputeShape (Client * c, int state, FramePixmap * frame_pix, int button_x[BUTTON_COUNT])
+{
+    ScreenInfo *screen_info;
+    GdkRegion *shape;
+    GdkRegion *bounds;
+    GdkRectangle rect;
+    XRectangle cut;
+    xfwmPixmap *my_pixmap;
+    gboolean ok;
+    int i;
+
+    screen_info = c->screen_info;
+
+    if (FLAG_TEST (c->flags, CLIENT_FLAG_HAS_SHAPE) && !FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
     {
-        rect.x = 0;
-        rect.y = 0;
-        rect.width  = frameWidth (c);
-        rect.height = frameHeight (c);
-        XShapeCombineRectangles (display_info->dpy, screen_info->shape_win, ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, Unsorted);
+        return NULL;
     }
-    else if (!FLAG_TEST (c->flags, CLIENT_FLAG_HAS_SHAPE))
+
+    shape = gdk_region_new ();
+    if (!FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
     {
         rect.x = frameLeft (c);
         rect.y = frameTop (c);
         rect.width  = c->width;
         rect.height = c->height;
-        XShapeCombineRectangles (display_info->dpy, screen_info->shape_win, ShapeBounding, 0, 0, &rect, 1, ShapeSet, Unsorted);
+        gdk_region_union_with_rect (shape, &rect);
     }
-    else
+
+    ok = TRUE;
+    if (frame_pix)
     {
-        XShapeCombineShape (display_info->dpy, screen_info->shape_win, ShapeBounding, frameLeft (c),
-                            frameTop (c), c->window, ShapeBounding, ShapeSet);
+        if (!FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
+        {
+            if (xfwmWindowVisible (&c->sides[SIDE_LEFT]))
+            {
+                ok &= frameShapeAddPiece (shape, &frame_pix->pm_sides[SIDE_LEFT], NULL,
+                                          0, frameTop (c));
+            }
+            if (xfwmWindowVisible (&c->sides[SIDE_RIGHT]))
+            {
+                ok &= frameShapeAddPiece (shape, &frame_pix->pm_sides[SIDE_RIGHT], NULL,
+                                          frameWidth (c) - frameRight (c), frameTop (c));
+            }
+        }
+
+        if (xfwmWindowVisible (&c->title))
+        {
+            ok &= frameShapeAddPiece (shape, &frame_pix->pm_title, NULL,
+                                      frameTopLeftWidth (c, state), 0);
+        }
+
+        if (xfwmWindowVisible (&c->corners[CORNER_TOP_LEFT]))
+        {
+            ok &= frameShapeAddPiece (shape, &screen_info->corners[CORNER_TOP_LEFT][state],
+                                      frameCornerCut (c, state, CORNER_TOP_LEFT, &cut) ? &cut : NULL,
+                                      0, 0);
+        }
+
+        if (xfwmWindowVisible (&c->sides[SIDE_BOTTOM]))
+        {
+            ok &= frameShapeAddPiece (shape, &frame_pix->pm_sides[SIDE_BOTTOM], NULL,
+                                      screen_info->corners[CORNER_BOTTOM_LEFT][state].width,
+                                      frameHeight (c) - frameBottom (c));
+        }
+
+        if (xfwmWindowVisible (&c->sides[SIDE_TOP]))
+        {
+            ok &= frameShapeAddPiece (shape, &frame_pix->pm_sides[SIDE_TOP], NULL,
+                                      screen_info->corners[CORNER_BOTTOM_LEFT][state].width,
+                                      frameTop (c) - frameBottom (c));
+        }
+
+        if (xfwmWindowVisible (&c->corners[CORNER_BOTTOM_LEFT]))
+        {
+            ok &= frameShapeAddPiece (shape, &screen_info->corners[CORNER_BOTTOM_LEFT][state],
+                                      frameCornerCut (c, state, CORNER_BOTTOM_LEFT, &cut) ? &cut : NULL,
+                                      0, frameHeight (c) - screen_info->corners[CORNER_BOTTOM_LEFT][state].height);
+        }
+
+        if (xfwmWindowVisible (&c->corners[CORNER_BOTTOM_RIGHT]))
+        {
+            ok &= frameShapeAddPiece (shape, &screen_info->corners[CORNER_BOTTOM_RIGHT][state],
+                                      frameCornerCut (c, state, CORNER_BOTTOM_RIGHT, &cut) ? &cut : NULL,
+                                      frameWidth (c) - screen_info->corners[CORNER_BOTTOM_RIGHT][state].width,
+                                      frameHeight (c) - screen_info->corners[CORNER_BOTTOM_RIGHT][state].height);
+        }
+
+        if (xfwmWindowVisible (&c->corners[CORNER_TOP_RIGHT]))
+        {
+            ok &= frameShapeAddPiece (shape, &screen_info->corners[CORNER_TOP_RIGHT][state],
+                                      frameCornerCut (c, state, CORNER_TOP_RIGHT, &cut) ? &cut : NULL,
+                                      frameWidth (c) - frameTopRightWidth (c, state), 0);
+        }
+
+        for (i = 0; (i < BUTTON_COUNT) && ok; i++)
+        {
+            if (xfwmWindowVisible (&c->buttons[i]))
+            {
+                my_pixmap = clientGetButtonPixmap (c, i, clientGetButtonState (c, i, state));
+                ok &= frameShapeAddPiece (shape, my_pixmap, NULL, button_x[i],
+                                          (frameTop (c) - screen_info->buttons[i][state].height + 1) / 2);
+            }
+        }
+    }
+
+    if (!ok)
+    {
+        gdk_region_destroy (shape);
+        return NULL;
     }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.width  = frameWidth (c);
+    rect.height = frameHeight (c);
+    bounds = gdk_region_rectangle (&rect);
+    gdk_region_intersect (shape, bounds);
+    gdk_region_destroy (bounds);
+
+    return shape;
+}
+
+static void
+frameSetShape (Client * c, int state, FramePixmap * frame_pix, int button_x[BUTTON_COUNT])
+{
+    ScreenInfo *screen_info;
+    DisplayInfo *display_info;
+    GdkRegion *shape;
+    GdkRectangle *rects;
+    XRectangle *xrects;
+    XRectangle rect;
+    xfwmPixmap *my_pixmap;
+    int i, count;
+
+    TRACE ("entering frameSetShape");
+    TRACE ("setting shape for client (0x%lx)", c->window);
+
+    screen_info = c->screen_info;
+    display_info = screen_info->display_info;
+
+    if (!display_info->have_shape)
+    {
+        return;
+    }
+
     if (frame_pix)
     {
         XShapeCombineMask (display_info->dpy, MYWINDOW_XWINDOW (c->title), ShapeBounding,
@@ -669,28 +923,18 @@ frameSetShape (Client * c, int state, FramePixmap * frame_pix, int button_x[BUTT
                                ShapeBounding, 0, 0, frame_pix->pm_sides[SIDE_TOP].mask, ShapeSet);
         }
 
-        if (xfwmWindowVisible (&c->corners[CORNER_BOTTOM_LEFT]))
+        for (i = 0; i < CORNER_COUNT; i++)
         {
-            XShapeCombineMask (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_BOTTOM_LEFT]),
-                               ShapeBounding, 0, 0, screen_info->corners[CORNER_BOTTOM_LEFT][state].mask, ShapeSet);
-        }
-
-        if (xfwmWindowVisible (&c->corners[CORNER_BOTTOM_RIGHT]))
-        {
-            XShapeCombineMask (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_BOTTOM_RIGHT]),
-                               ShapeBounding, 0, 0, screen_info->corners[CORNER_BOTTOM_RIGHT][state].mask, ShapeSet);
-        }
-
-        if (xfwmWindowVisible (&c->corners[CORNER_TOP_LEFT]))
-        {
-            XShapeCombineMask (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_TOP_LEFT]),
-                               ShapeBounding, 0, 0, screen_info->corners[CORNER_TOP_LEFT][state].mask, ShapeSet);
-        }
-
-        if (xfwmWindowVisible (&c->corners[CORNER_TOP_RIGHT]))
-        {
-            XShapeCombineMask (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_TOP_RIGHT]),
-                               ShapeBounding, 0, 0, screen_info->corners[CORNER_TOP_RIGHT][state].mask, ShapeSet);
+            if (xfwmWindowVisible (&c->corners[i]))
+            {
+                XShapeCombineMask (display_info->dpy, MYWINDOW_XWINDOW (c->corners[i]),
+                                   ShapeBounding, 0, 0, screen_info->corners[i][state].mask, ShapeSet);
+                if (frameCornerCut (c, state, i, &rect))
+                {
+                    XShapeCombineRectangles (display_info->dpy, MYWINDOW_XWINDOW (c->corners[i]),
+                                             ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, 0);
+                }
+            }
         }
 
         for (i = 0; i < BUTTON_COUNT; i++)
@@ -702,55 +946,79 @@ frameSetShape (Client * c, int state, FramePixmap * frame_pix, int button_x[BUTT
                                    ShapeBounding, 0, 0, my_pixmap->mask, ShapeSet);
             }
         }
+    }
 
-        if (xfwmWindowVisible (&c->corners[CORNER_TOP_LEFT]) &&
-            (screen_info->corners[CORNER_TOP_LEFT][state].height > frameHeight (c) - frameBottom (c) + 1))
+    shape = frameComputeShape (c, state, frame_pix, button_x);
+    if (shape)
+    {
+        if ((c->frame_shape) && gdk_region_equal (shape, c->frame_shape))
         {
-            rect.x      = 0;
-            rect.y      = frameHeight (c) - frameBottom (c) + 1;
-            rect.width  = frameTopLeftWidth (c, state);
-            rect.height = screen_info->corners[CORNER_TOP_LEFT][state].height
-                           - (frameHeight (c) - frameBottom (c) + 1);
-            XShapeCombineRectangles (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_TOP_LEFT]),
-                                     ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, 0);
+            TRACE ("frame shape unchanged for client (0x%lx)", c->window);
+            gdk_region_destroy (shape);
+            return;
         }
 
-        if (xfwmWindowVisible (&c->corners[CORNER_TOP_RIGHT]) &&
-            (screen_info->corners[CORNER_TOP_RIGHT][state].height > frameHeight (c) - frameBottom (c) + 1))
+        gdk_region_get_rectangles (shape, &rects, &count);
+        xrects = g_new (XRectangle, MAX (count, 1));
+        for (i = 0; i < count; i++)
         {
-            rect.x      = 0;
-            rect.y      = frameHeight (c) - frameBottom (c) + 1;
-            rect.width  = frameTopRightWidth (c, state);
-            rect.height = screen_info->corners[CORNER_TOP_RIGHT][state].height
-                           - (frameHeight (c) - frameBottom (c) + 1);
-            XShapeCombineRectangles (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_TOP_RIGHT]),
-                                     ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, 0);
+            xrects[i].x = rects[i].x;
+            xrects[i].y = rects[i].y;
+            xrects[i].width = rects[i].width;
+            xrects[i].height = rects[i].height;
         }
+        XShapeCombineRectangles (display_info->dpy, c->frame, ShapeBounding, 0, 0,
+                                 xrects, count, ShapeSet, YXBanded);
+        g_free (xrects);
+        g_free (rects);
 
-        if (xfwmWindowVisible (&c->corners[CORNER_BOTTOM_LEFT]) &&
-            (screen_info->corners[CORNER_BOTTOM_LEFT][state].height > frameHeight (c) - frameTop (c) + 1))
+        if (c->frame_shape)
         {
-            rect.x      = 0;
-            rect.y      = 0;
-            rect.width  = screen_info->corners[CORNER_BOTTOM_LEFT][state].width;
-            rect.height = screen_info->corners[CORNER_BOTTOM_LEFT][state].height
-                           - (frameHeight (c) - frameTop (c) + 1);
-            XShapeCombineRectangles (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_BOTTOM_LEFT]),
-                                     ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, 0);
+            gdk_region_destroy (c->frame_shape);
         }
+        c->frame_shape = shape;
+        return;
+    }
 
-        if (xfwmWindowVisible (&c->corners[CORNER_BOTTOM_RIGHT]) &&
-            (screen_info->corners[CORNER_BOTTOM_RIGHT][state].height > frameHeight (c) - frameTop (c) + 1))
-        {
-            rect.x      = 0;
-            rect.y      = 0;
-            rect.width  = screen_info->corners[CORNER_BOTTOM_RIGHT][state].width;
-            rect.height = screen_info->corners[CORNER_BOTTOM_RIGHT][state].height
-                           - (frameHeight (c) - frameTop (c) + 1);
-            XShapeCombineRectangles (display_info->dpy, MYWINDOW_XWINDOW (c->corners[CORNER_BOTTOM_RIGHT]),
-                                     ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, 0);
-        }
+    /* Fall back to building the shape on the server */
+    if (c->frame_shape)
+    {
+        gdk_region_destroy (c->frame_shape);
+        c->frame_shape = NULL;
+    }
 
+    if (screen_info->shape_win == None)
+    {
+        screen_info->shape_win = XCreateSimpleWindow (display_info->dpy, screen_info->xroot, 0, 0, frameWidth (c), frameHeight (c), 0, 0, 0);
+    }
+    else
+    {
+        XResizeWindow (display_info->dpy, screen_info->shape_win, frameWidth (c), frameHeight (c));
+    }
+
+    if (FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
+    {
+        rect.x = 0;
+        rect.y = 0;
+        rect.width  = frameWidth (c);
+        rect.height = frameHeight (c);
+        XShapeCombineRectangles (display_info->dpy, screen_info->shape_win, ShapeBounding, 0, 0, &rect, 1, ShapeSubtract, Unsorted);
+    }
+    else if (!FLAG_TEST (c->flags, CLIENT_FLAG_HAS_SHAPE))
+    {
+        rect.x = frameLeft (c);
+        rect.y = frameTop (c);
+        rect.width  = c->width;
+        rect.height = c->height;
+        XShapeCombineRectangles (display_info->dpy, screen_info->shape_win, ShapeBounding, 0, 0, &rect, 1, ShapeSet, Unsorted);
+    }
+    else
+    {
+        XShapeCombineShape (display_info->dpy, screen_info->shape_win, ShapeBounding, frameLeft (c),
+                            frameTop (c), c->window, ShapeBounding, ShapeSet);
+    }
+    if (frame_pix)
+    {
         if (!FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
         {
             if (xfwmWindowVisible (&c->sides[SIDE_LEFT]))
@@ -874,6 +1142,7 @@ frameDrawWin (Client * c)
 {
     ScreenInfo *screen_info;
     FramePixmap frame_pix;
+    TitleCache *title_cache;
     xfwmPixmap *my_pixmap;
     gint state, x, button, left, right;
     gint top_width, bottom_width, left_height, right_height;
@@ -936,6 +1205,8 @@ frameDrawWin (Client * c)
     if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_NEEDS_REDRAW))
     {
         FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_NEEDS_REDRAW);
+        /* Theme, font or title changes */
+        frameClearTitleCache (c);
         width_changed = TRUE;
         height_changed = TRUE;
         requires_clearing = TRUE;
@@ -1051,14 +1322,14 @@ frameDrawWin (Client * c)
         right_height = frameHeight (c) - frameTop (c) -
             screen_info->corners[CORNER_BOTTOM_RIGHT][state].height;
 
-        xfwmPixmapInit (screen_info, &frame_pix.pm_title);
-        xfwmPixmapInit (screen_info, &frame_pix.pm_sides[SIDE_TOP]);
         xfwmPixmapInit (screen_info, &frame_pix.pm_sides[SIDE_BOTTOM]);
         xfwmPixmapInit (screen_info, &frame_pix.pm_sides[SIDE_LEFT]);
         xfwmPixmapInit (screen_info, &frame_pix.pm_sides[SIDE_RIGHT]);
 
-        /* The title is always visible */
-        frameCreateTitlePixmap (c, state, left, right, &frame_pix.pm_title, &frame_pix.pm_sides[SIDE_TOP]);
+        /* The title is always visible, its pixmaps belong to the title cache */
+        title_cache = frameGetTitlePixmap (c, state, left, right);
+        frame_pix.pm_title = title_cache->pm_title;
+        frame_pix.pm_sides[SIDE_TOP] = title_cache->pm_top;
         xfwmWindowSetBG (&c->title, &frame_pix.pm_title);
         xfwmWindowShow (&c->title,
             frameTopLeftWidth (c, state), 0, top_width,
@@ -1174,8 +1445,6 @@ frameDrawWin (Client * c)
         }
         frameSetShape (c, state, &frame_pix, button_x);
 
-        xfwmPixmapFree (&frame_pix.pm_title);
-        xfwmPixmapFree (&frame_pix.pm_sides[SIDE_TOP]);
         xfwmPixmapFree (&frame_pix.pm_sides[SIDE_BOTTOM]);
         xfwmPixmapFree (&frame_pix.pm_sides[SIDE_LEFT]);
         xfwmPixmapFree (&frame_pix.pm_sides[SIDE_RIGHT]);
@@ -1214,15 +1483,32 @@ frameDrawWin (Client * c)
 static gboolean
 update_frame_idle_cb (gpointer data)
 {
+    ScreenInfo *screen_info;
+    GList *list;
     Client *c;
 
     TRACE ("entering update_frame_idle_cb");
 
-    c = (Client *) data;
-    g_return_val_if_fail (c, FALSE);
+    screen_info = (ScreenInfo *) data;
+    g_return_val_if_fail (screen_info, FALSE);
 
-    frameDrawWin (c);
-    c->frame_timeout_id = 0;
+    screen_info->frame_idle_id = 0;
+
+    /* Draw all the queued frames in a single pass, bottom to top */
+    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+    {
+        c = (Client *) list->data;
+        if (c->frame_queued)
+        {
+            frameDrawWin (c);
+        }
+    }
+    /* Clients not in the stack yet, if any */
+    while (screen_info->frame_queue)
+    {
+        frameDrawWin ((Client *) screen_info->frame_queue->data);
+    }
+    XFlush (myScreenGetXDisplay (screen_info));
 
     return (FALSE);
 }
@@ -1230,14 +1516,17 @@ update_frame_idle_cb (gpointer data)
 void
 frameClearQueueDraw (Client * c)
 {
+    ScreenInfo *screen_info;
+
     g_return_if_fail (c);
 
     TRACE ("entering frameClearQueueDraw for \"%s\" (0x%lx)", c->name, c->window);
 
-    if (c->frame_timeout_id)
+    if (c->frame_queued)
     {
-        g_source_remove (c->frame_timeout_id);
-        c->frame_timeout_id = 0;
+        screen_info = c->screen_info;
+        screen_info->frame_queue = g_slist_remove (screen_info->frame_queue, c);
+        c->frame_queued = FALSE;
     }
 }
 
@@ -1258,24 +1547,27 @@ frameDraw (Client * c, gboolean clear_all)
 void
 frameQueueDraw (Client * c, gboolean clear_all)
 {
+    ScreenInfo *screen_info;
+
     g_return_if_fail (c);
 
     TRACE ("entering frameQueueDraw for \"%s\" (0x%lx)", c->name, c->window);
 
-    /* Reschedule update */
-    if (c->frame_timeout_id)
-    {
-        frameClearQueueDraw (c);
-    }
     if (clear_all)
     {
         FLAG_SET (c->xfwm_flags, XFWM_FLAG_NEEDS_REDRAW);
     }
-    /* Otherwise leave previous schedule */
-    if (c->frame_timeout_id == 0)
+    if (!c->frame_queued)
     {
-        c->frame_timeout_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
-                                              update_frame_idle_cb, c, NULL);
+        screen_info = c->screen_info;
+        screen_info->frame_queue = g_slist_prepend (screen_info->frame_queue, c);
+        c->frame_queued = TRUE;
+        /* One redraw pass for all the frames queued on this screen */
+        if (screen_info->frame_idle_id == 0)
+        {
+            screen_info->frame_idle_id = g_idle_add_full (G_PRIORITY_DEFAULT_IDLE,
+                                                          update_frame_idle_cb, screen_info, NULL);
+        }
     }
 }
 
@@ -45,6 +45,8 @@ int                      frameY                                 (Client *);
 int                      frameWidth                             (Client *);
 int                      frameHeight                            (Client *);
 void                     frameSetShapeInput                     (Client *);
+void                     frameInitTitleCache                    (Client *);
+void                     frameClearTitleCache                   (Client *);
 void                     frameClearQueueDraw                    (Client *);
 void                     frameQueueDraw                         (Client *,
                                                                  gboolean);
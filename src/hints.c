@@ -44,6 +44,8 @@
 #include "display.h"
 #include "screen.h"
 #include "hints.h"
+#include "misc.h"
+#include "stats.h"
 
 static gboolean
 check_type_and_format (int expected_format, Atom expected_type, int n_items, int format, Atom type)
@@ -75,6 +77,322 @@ internal_utf8_strndup (const gchar *src, gssize max_len)
     return g_strndup (src, s - src);
 }
 
+/*
+ * Property reads can be requested ahead of time through XCB, so that
+ * the getters below collect replies already on their way instead of
+ * waiting for a round trip each. Up to PREFETCH_MAX_LENGTH 32-bit
+ * units are fetched, larger properties are read again from the server.
+ */
+#define PREFETCH_MAX_LENGTH 1024L
+
+typedef struct _PropertyPrefetch PropertyPrefetch;
+struct _PropertyPrefetch
+{
+    Atom property;
+    xcb_get_property_cookie_t cookie;
+};
+
+static PropertyPrefetch *
+take_prefetched_property (DisplayInfo *display_info, Window w, Atom property)
+{
+    PropertyPrefetch *prefetch;
+    GSList *list;
+
+    for (list = multimapLookup (display_info->property_prefetch, (gconstpointer) w); list; list = g_slist_next (list))
+    {
+        prefetch = (PropertyPrefetch *) list->data;
+        if (prefetch->property == property)
+        {
+            multimapRemove (display_info->property_prefetch, (gpointer) w, prefetch);
+            return prefetch;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Answer a read from offset 0 out of a prefetched reply, the same way
+ * the server and XGetWindowProperty() would. The data is allocated with
+ * malloc() like Xlib does so that callers can XFree() it. Returns FALSE
+ * if the reply does not hold enough of the property.
+ */
+static gboolean
+get_prefetched_property (xcb_get_property_reply_t *reply, long length, Atom req_type,
+                         Atom *type, int *format, unsigned long *nitems,
+                         unsigned long *bytes_after, unsigned char **data)
+{
+    unsigned long fetched, total, wanted, i;
+    unsigned char *value;
+
+    *type = reply->type;
+    *format = reply->format;
+    *nitems = 0;
+    *bytes_after = 0;
+    *data = NULL;
+
+    if (reply->type == None)
+    {
+        *format = 0;
+        return TRUE;
+    }
+    if ((reply->format != 8) && (reply->format != 16) && (reply->format != 32))
+    {
+        return FALSE;
+    }
+
+    fetched = (unsigned long) xcb_get_property_value_length (reply);
+    total = fetched + reply->bytes_after;
+    if ((req_type != AnyPropertyType) && (req_type != reply->type))
+    {
+        /* Like the server, report the size but no data on type mismatch */
+        wanted = 0;
+    }
+    else if ((unsigned long) length <= total / 4)
+    {
+        wanted = (unsigned long) length * 4;
+    }
+    else
+    {
+        wanted = total;
+    }
+    if (wanted > fetched)
+    {
+        return FALSE;
+    }
+
+    *nitems = wanted / (reply->format / 8);
+    *bytes_after = total - wanted;
+    value = (unsigned char *) xcb_get_property_value (reply);
+
+    /* Xlib returns 32-bit items as longs, and always adds a trailing nul */
+    switch (reply->format)
+    {
+        case 32:
+            *data = calloc (*nitems * sizeof (long) + 1, 1);
+            if (*data)
+            {
+                for (i = 0; i < *nitems; i++)
+                {
+                    ((unsigned long *) *data)[i] = ((guint32 *) value)[i];
+                }
+            }
+            break;
+        case 16:
+            *data = calloc (*nitems * sizeof (short) + 1, 1);
+            if (*data)
+            {
+                memcpy (*data, value, *nitems * sizeof (short));
+            }
+            break;
+        default:
+            *data = calloc (*nitems + 1, 1);
+            if (*data)
+            {
+                memcpy (*data, value, *nitems);
+            }
+            break;
+    }
+
+    return (*data != NULL);
+}
+
+/*
+ * XGetWindowProperty() from offset 0 without deleting the property,
+ * served from a prefetched reply when there is one.
+ */
+static int
+get_window_property (DisplayInfo *display_info, Window w, Atom property, long length,
+                     Atom req_type, Atom *type, int *format, unsigned long *nitems,
+                     unsigned long *bytes_after, unsigned char **data)
+{
+    PropertyPrefetch *prefetch;
+    xcb_get_property_reply_t *reply;
+    xcb_generic_error_t *error;
+    gboolean done;
+
+    prefetch = take_prefetched_property (display_info, w, property);
+    if (prefetch)
+    {
+        error = NULL;
+        reply = xcb_get_property_reply (display_info->xcb, prefetch->cookie, &error);
+        g_free (prefetch);
+
+        /* On error, read it again so that Xlib reports the error as usual */
+        if (error)
+        {
+            free (error);
+        }
+        if (reply)
+        {
+            done = get_prefetched_property (reply, length, req_type, type, format,
+                                            nitems, bytes_after, data);
+            free (reply);
+            if (done)
+            {
+                statsCount (STATS_PREFETCH_PROPERTY);
+                return Success;
+            }
+        }
+    }
+
+    statsCount (STATS_GET_PROPERTY);
+    return XGetWindowProperty (display_info->dpy, w, property, 0L, length, FALSE, req_type,
+                               type, format, nitems, bytes_after, data);
+}
+
+/*
+ * Same as XGetTextProperty(), through get_window_property().
+ */
+static gboolean
+get_xtext_property (DisplayInfo *display_info, Window w, Atom a, XTextProperty *tp)
+{
+    unsigned long bytes_after;
+
+    tp->value = NULL;
+    tp->encoding = None;
+    tp->format = 0;
+    tp->nitems = 0;
+
+    if ((get_window_property (display_info, w, a, G_MAXLONG, AnyPropertyType,
+                              &tp->encoding, &tp->format, &tp->nitems, &bytes_after,
+                              &tp->value) != Success) || (tp->encoding == None))
+    {
+        if (tp->value)
+        {
+            XFree (tp->value);
+            tp->value = NULL;
+        }
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void
+prefetchWindowProperty (DisplayInfo *display_info, Window w, Atom property)
+{
+    PropertyPrefetch *prefetch;
+
+    g_return_if_fail (display_info != NULL);
+    g_return_if_fail (w != None);
+
+    TRACE ("entering prefetchWindowProperty");
+
+    /* A reply requested earlier may predate the last change */
+    prefetch = take_prefetched_property (display_info, w, property);
+    if (prefetch)
+    {
+        xcb_discard_reply (display_info->xcb, prefetch->cookie.sequence);
+    }
+    else
+    {
+        prefetch = g_new0 (PropertyPrefetch, 1);
+        prefetch->property = property;
+    }
+
+    prefetch->cookie = xcb_get_property (display_info->xcb, FALSE, w, property,
+                                         XCB_GET_PROPERTY_TYPE_ANY, 0, PREFETCH_MAX_LENGTH);
+    multimapInsert (display_info->property_prefetch, (gpointer) w, prefetch);
+}
+
+/*
+ * Request all the properties read when framing a client. Only the ones
+ * the client owns, or that are read before xfwm4 writes them, are worth
+ * it: a prefetched reply is used once, by the first read.
+ */
+void
+prefetchClientProperties (DisplayInfo *display_info, Window w)
+{
+    static const int atom_ids[] = {
+        NET_WM_NAME,
+        WM_CLIENT_MACHINE,
+        WM_TRANSIENT_FOR,
+        WM_HINTS,
+        WM_PROTOCOLS,
+        WM_COLORMAP_WINDOWS,
+        WM_CLIENT_LEADER,
+        WM_WINDOW_ROLE,
+        MOTIF_WM_HINTS,
+        NET_WM_USER_TIME_WINDOW,
+        NET_WM_USER_TIME,
+        NET_WM_PID,
+        NET_WM_WINDOW_OPACITY,
+        NET_WM_WINDOW_OPACITY_LOCKED,
+        NET_WM_STATE,
+        NET_WM_WINDOW_TYPE,
+        NET_WM_DESKTOP,
+        NET_WM_STRUT_PARTIAL,
+        NET_WM_STRUT,
+#ifdef HAVE_XSYNC
+        NET_WM_SYNC_REQUEST_COUNTER,
+#endif /* HAVE_XSYNC */
+#ifdef HAVE_LIBSTARTUP_NOTIFICATION
+        NET_STARTUP_ID,
+#endif /* HAVE_LIBSTARTUP_NOTIFICATION */
+    };
+    guint i;
+
+    g_return_if_fail (display_info != NULL);
+    g_return_if_fail (w != None);
+
+    TRACE ("entering prefetchClientProperties");
+
+    prefetchWindowProperty (display_info, w, XA_WM_NAME);
+    prefetchWindowProperty (display_info, w, XA_WM_NORMAL_HINTS);
+    prefetchWindowProperty (display_info, w, XA_WM_CLASS);
+    for (i = 0; i < G_N_ELEMENTS (atom_ids); i++)
+    {
+        prefetchWindowProperty (display_info, w, display_info->atoms[atom_ids[i]]);
+    }
+}
+
+static void
+discard_prefetched_list (DisplayInfo *display_info, GSList *entries)
+{
+    PropertyPrefetch *prefetch;
+    GSList *list;
+
+    for (list = entries; list; list = g_slist_next (list))
+    {
+        prefetch = (PropertyPrefetch *) list->data;
+        xcb_discard_reply (display_info->xcb, prefetch->cookie.sequence);
+        g_free (prefetch);
+    }
+    g_slist_free (entries);
+}
+
+void
+discardPrefetchedProperties (DisplayInfo *display_info, Window w)
+{
+    GSList *entries;
+
+    g_return_if_fail (display_info != NULL);
+
+    entries = multimapLookup (display_info->property_prefetch, (gconstpointer) w);
+    if (entries)
+    {
+        g_hash_table_remove (display_info->property_prefetch, (gconstpointer) w);
+        discard_prefetched_list (display_info, entries);
+    }
+}
+
+static gboolean
+discard_prefetched_cb (gpointer key, gpointer value, gpointer user_data)
+{
+    discard_prefetched_list ((DisplayInfo *) user_data, (GSList *) value);
+
+    return TRUE;
+}
+
+void
+discardAllPrefetchedProperties (DisplayInfo *display_info)
+{
+    g_return_if_fail (display_info != NULL);
+
+    g_hash_table_foreach_remove (display_info->property_prefetch, discard_prefetched_cb, display_info);
+}
+
 unsigned long
 getWMState (DisplayInfo *display_info, Window w)
 {
@@ -88,10 +406,9 @@ getWMState (DisplayInfo *display_info, Window w)
 
     data = NULL;
     state = WithdrawnState;
-    if ((XGetWindowProperty (display_info->dpy, w, display_info->atoms[WM_STATE],
-                             0, 3L, FALSE, display_info->atoms[WM_STATE],
-                             &real_type, &real_format, &items_read, &items_left,
-                             (unsigned char **) &data) == Success) && (items_read))
+    if ((get_window_property (display_info, w, display_info->atoms[WM_STATE], 3L,
+                              display_info->atoms[WM_STATE], &real_type, &real_format,
+                              &items_read, &items_left, (unsigned char **) &data) == Success) && (items_read))
     {
         state = *data;
         if (data)
@@ -130,9 +447,10 @@ getMotifHints (DisplayInfo *display_info, Window w)
 
     data = NULL;
     result = NULL;
-    if ((XGetWindowProperty (display_info->dpy, w, display_info->atoms[MOTIF_WM_HINTS], 0L, MWM_HINTS_ELEMENTS,
-                FALSE, display_info->atoms[MOTIF_WM_HINTS], &real_type, &real_format, &items_read,
-                &items_left, (unsigned char **) &data) == Success))
+    if ((get_window_property (display_info, w, display_info->atoms[MOTIF_WM_HINTS],
+                              MWM_HINTS_ELEMENTS, display_info->atoms[MOTIF_WM_HINTS],
+                              &real_type, &real_format, &items_read, &items_left,
+                              (unsigned char **) &data) == Success))
     {
         if (items_read >= MWM_HINTS_ELEMENTS)
         {
@@ -161,7 +479,7 @@ getWMProtocols (DisplayInfo *display_info, Window w)
     TRACE ("entering getWMProtocols");
 
     result = 0;
-    if (XGetWMProtocols (display_info->dpy, w, &protocols, &n))
+    if (getAtomList (display_info, w, WM_PROTOCOLS, &protocols, &n))
     {
         for (i = 0, ap = protocols; i < n; i++, ap++)
         {
@@ -191,11 +509,9 @@ getWMProtocols (DisplayInfo *display_info, Window w)
     }
     else
     {
-        if ((XGetWindowProperty (display_info->dpy, w,
-                    display_info->atoms[WM_PROTOCOLS], 0L, 10L, FALSE,
-                    display_info->atoms[WM_PROTOCOLS], &atype,
-                    &aformat, &nitems, &bytes_remain,
-                    (unsigned char **) &data)) == Success)
+        if ((get_window_property (display_info, w, display_info->atoms[WM_PROTOCOLS], 10L,
+                                  display_info->atoms[WM_PROTOCOLS], &atype, &aformat,
+                                  &nitems, &bytes_remain, (unsigned char **) &data)) == Success)
         {
             for (i = 0, ap = (Atom *) data; (unsigned long) i < nitems; i++, ap++)
             {
@@ -238,9 +554,9 @@ getHint (DisplayInfo *display_info, Window w, int atom_id, long *value)
     *value = 0;
     data = NULL;
 
-    if ((XGetWindowProperty (display_info->dpy, w, display_info->atoms[atom_id], 0L, 1L,
-                             FALSE, XA_CARDINAL, &real_type, &real_format, &items_read, &items_left,
-                             (unsigned char **) &data) == Success) && (items_read))
+    if ((get_window_property (display_info, w, display_info->atoms[atom_id], 1L, XA_CARDINAL,
+                              &real_type, &real_format, &items_read, &items_left,
+                              (unsigned char **) &data) == Success) && (items_read))
     {
         *value = *((long *) data);
         if (data)
@@ -279,10 +595,9 @@ getDesktopLayout (DisplayInfo *display_info, Window root, int ws_count, NetWmDes
     data = NULL;
     success = FALSE;
 
-    if ((XGetWindowProperty (display_info->dpy, root, display_info->atoms[NET_DESKTOP_LAYOUT],
-                0L, 4L, FALSE, XA_CARDINAL,
-                &real_type, &real_format, &items_read, &items_left,
-                (unsigned char **) &data) == Success) && (items_read >= 3))
+    if ((get_window_property (display_info, root, display_info->atoms[NET_DESKTOP_LAYOUT], 4L,
+                              XA_CARDINAL, &real_type, &real_format, &items_read,
+                              &items_left, (unsigned char **) &data) == Success) && (items_read >= 3))
     {
         do
         {
@@ -448,9 +763,9 @@ getAtomList (DisplayInfo *display_info, Window w, int atom_id, Atom ** atoms_p,
     g_return_val_if_fail (((atom_id >= 0) && (atom_id < ATOM_COUNT)), FALSE);
     TRACE ("entering getAtomList()");
 
-    if ((XGetWindowProperty (display_info->dpy, w, display_info->atoms[atom_id],
-                             0, G_MAXLONG, FALSE, XA_ATOM, &type, &format, &n_atoms,
-                             &bytes_after, (unsigned char **) &data) != Success) || (type == None))
+    if ((get_window_property (display_info, w, display_info->atoms[atom_id], G_MAXLONG, XA_ATOM,
+                              &type, &format, &n_atoms, &bytes_after,
+                              (unsigned char **) &data) != Success) || (type == None))
     {
         return FALSE;
     }
@@ -488,10 +803,9 @@ getCardinalList (DisplayInfo *display_info, Window w, int atom_id, unsigned long
     g_return_val_if_fail (((atom_id >= 0) && (atom_id < ATOM_COUNT)), FALSE);
     TRACE ("entering getCardinalList()");
 
-    if ((XGetWindowProperty (display_info->dpy, w, display_info->atoms[atom_id],
-                             0, G_MAXLONG, FALSE, XA_CARDINAL,
-                             &type, &format, &n_cardinals, &bytes_after,
-                             (unsigned char **) &data) != Success) || (type == None))
+    if ((get_window_property (display_info, w, display_info->atoms[atom_id], G_MAXLONG, XA_CARDINAL,
+                              &type, &format, &n_cardinals, &bytes_after,
+                              (unsigned char **) &data) != Success) || (type == None))
     {
         return FALSE;
     }
@@ -609,9 +923,29 @@ setUTF8StringHint (DisplayInfo *display_info, Window w, int atom_id, const gchar
 void
 getTransientFor (DisplayInfo *display_info, Window root, Window w, Window * transient_for)
 {
+    Atom type;
+    int format;
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+    gboolean found;
+
     TRACE ("entering getTransientFor");
 
-    if (XGetTransientForHint (display_info->dpy, w, transient_for))
+    data = NULL;
+    found = FALSE;
+    if ((get_window_property (display_info, w, display_info->atoms[WM_TRANSIENT_FOR], 1L, XA_WINDOW,
+                              &type, &format, &nitems, &bytes_after, &data) == Success) &&
+        (type == XA_WINDOW) && (format == 32) && (nitems != 0))
+    {
+        *transient_for = *((Window *) data);
+        found = TRUE;
+    }
+    if (data)
+    {
+        XFree (data);
+    }
+
+    if (found)
     {
         if (*transient_for == None)
         {
@@ -632,6 +966,194 @@ getTransientFor (DisplayInfo *display_info, Window root, Window w, Window * tran
     TRACE ("Window (0x%lx) is transient for (0x%lx)", w, *transient_for);
 }
 
+/*
+ * The getters below replace XGetWMHints(), XGetWMNormalHints(),
+ * XGetClassHint() and XGetWMColormapWindows() so that these reads can
+ * be served from prefetched replies too. They decode the properties the
+ * same way as Xlib, and the results are freed with XFree() as before.
+ */
+#define WM_HINTS_ELEMENTS       9L
+#define WM_SIZE_HINTS_ELEMENTS  18L
+#define WM_SIZE_HINTS_OLD       15L
+
+XWMHints *
+getWMHints (DisplayInfo *display_info, Window w)
+{
+    Atom type;
+    int format;
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+    unsigned long *prop;
+    XWMHints *hints;
+
+    TRACE ("entering getWMHints");
+
+    data = NULL;
+    hints = NULL;
+    if ((get_window_property (display_info, w, display_info->atoms[WM_HINTS], WM_HINTS_ELEMENTS,
+                              XA_WM_HINTS, &type, &format, &nitems, &bytes_after,
+                              &data) == Success) &&
+        (type == XA_WM_HINTS) && (format == 32) && (nitems >= WM_HINTS_ELEMENTS - 1))
+    {
+        hints = XAllocWMHints ();
+        if (hints)
+        {
+            prop = (unsigned long *) data;
+            hints->flags = prop[0];
+            hints->input = (prop[1] ? True : False);
+            hints->initial_state = (int) (gint32) prop[2];
+            hints->icon_pixmap = prop[3];
+            hints->icon_window = prop[4];
+            hints->icon_x = (int) (gint32) prop[5];
+            hints->icon_y = (int) (gint32) prop[6];
+            hints->icon_mask = prop[7];
+            /* Pre-R3 clients truncated the window group */
+            hints->window_group = ((nitems >= WM_HINTS_ELEMENTS) ? prop[8] : None);
+        }
+    }
+    if (data)
+    {
+        XFree (data);
+    }
+
+    return hints;
+}
+
+gboolean
+getWMNormalHints (DisplayInfo *display_info, Window w, XSizeHints *hints)
+{
+    Atom type;
+    int format;
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+    long *prop;
+    long supplied;
+
+    TRACE ("entering getWMNormalHints");
+
+    data = NULL;
+    if ((get_window_property (display_info, w, XA_WM_NORMAL_HINTS, WM_SIZE_HINTS_ELEMENTS,
+                              XA_WM_SIZE_HINTS, &type, &format, &nitems, &bytes_after,
+                              &data) != Success) ||
+        (type != XA_WM_SIZE_HINTS) || (format != 32) || (nitems < WM_SIZE_HINTS_OLD))
+    {
+        if (data)
+        {
+            XFree (data);
+        }
+        return FALSE;
+    }
+
+    prop = (long *) data;
+    hints->flags = prop[0];
+    hints->x = (int) (gint32) prop[1];
+    hints->y = (int) (gint32) prop[2];
+    hints->width = (int) (gint32) prop[3];
+    hints->height = (int) (gint32) prop[4];
+    hints->min_width = (int) (gint32) prop[5];
+    hints->min_height = (int) (gint32) prop[6];
+    hints->max_width = (int) (gint32) prop[7];
+    hints->max_height = (int) (gint32) prop[8];
+    hints->width_inc = (int) (gint32) prop[9];
+    hints->height_inc = (int) (gint32) prop[10];
+    hints->min_aspect.x = (int) (gint32) prop[11];
+    hints->min_aspect.y = (int) (gint32) prop[12];
+    hints->max_aspect.x = (int) (gint32) prop[13];
+    hints->max_aspect.y = (int) (gint32) prop[14];
+
+    supplied = (USPosition | USSize | PAllHints);
+    if (nitems >= WM_SIZE_HINTS_ELEMENTS)
+    {
+        hints->base_width = (int) (gint32) prop[15];
+        hints->base_height = (int) (gint32) prop[16];
+        hints->win_gravity = (int) (gint32) prop[17];
+        supplied |= (PBaseSize | PWinGravity);
+    }
+    hints->flags &= supplied;
+    XFree (data);
+
+    return TRUE;
+}
+
+gboolean
+getClassHint (DisplayInfo *display_info, Window w, XClassHint *class_hint)
+{
+    Atom type;
+    int format;
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+    int len_name;
+    gboolean status;
+
+    TRACE ("entering getClassHint");
+
+    data = NULL;
+    status = FALSE;
+    if ((get_window_property (display_info, w, XA_WM_CLASS, BUFSIZ, XA_STRING,
+                              &type, &format, &nitems, &bytes_after, &data) == Success) &&
+        (type == XA_STRING) && (format == 8))
+    {
+        /* Both strings are nul terminated, the class one may not be */
+        len_name = (int) strlen ((char *) data);
+        if ((unsigned long) len_name == nitems)
+        {
+            len_name--;
+        }
+        class_hint->res_name = malloc (strlen ((char *) data) + 1);
+        class_hint->res_class = malloc (strlen ((char *) data + len_name + 1) + 1);
+        if ((class_hint->res_name) && (class_hint->res_class))
+        {
+            strcpy (class_hint->res_name, (char *) data);
+            strcpy (class_hint->res_class, (char *) data + len_name + 1);
+            status = TRUE;
+        }
+        else
+        {
+            free (class_hint->res_name);
+            free (class_hint->res_class);
+            class_hint->res_name = NULL;
+            class_hint->res_class = NULL;
+        }
+    }
+    if (data)
+    {
+        XFree (data);
+    }
+
+    return status;
+}
+
+gboolean
+getWMColormapWindows (DisplayInfo *display_info, Window w, Window **windows, int *count)
+{
+    Atom type;
+    int format;
+    unsigned long nitems, bytes_after;
+    unsigned char *data;
+
+    TRACE ("entering getWMColormapWindows");
+
+    *windows = NULL;
+    *count = 0;
+    data = NULL;
+    if ((get_window_property (display_info, w, display_info->atoms[WM_COLORMAP_WINDOWS], G_MAXLONG,
+                              XA_WINDOW, &type, &format, &nitems, &bytes_after,
+                              &data) != Success) ||
+        (type != XA_WINDOW) || (format != 32))
+    {
+        if (data)
+        {
+            XFree (data);
+        }
+        return FALSE;
+    }
+
+    *windows = (Window *) data;
+    *count = (int) nitems;
+
+    return TRUE;
+}
+
 static char *
 text_property_to_utf8 (DisplayInfo *display_info, const XTextProperty * prop)
 {
@@ -664,7 +1186,7 @@ get_text_property (DisplayInfo *display_info, Window w, Atom a)
 
     TRACE ("entering get_text_property");
     text.nitems = 0;
-    if (XGetTextProperty (display_info->dpy, w, &text, a))
+    if (get_xtext_property (display_info, w, a, &text))
     {
         retval = text_property_to_utf8 (display_info, &text);
         if (retval)
@@ -679,7 +1201,7 @@ get_text_property (DisplayInfo *display_info, Window w, Atom a)
     else
     {
         retval = NULL;
-        TRACE ("XGetTextProperty() failed");
+        TRACE ("get_xtext_property() failed");
     }
 
     return retval;
@@ -699,9 +1221,9 @@ getUTF8StringData (DisplayInfo *display_info, Window w, int atom_id, gchar **str
     TRACE ("entering getUTF8StringData");
 
     *str_p = NULL;
-    if ((XGetWindowProperty (display_info->dpy, w, display_info->atoms[atom_id],
-                             0, G_MAXLONG, FALSE, display_info->atoms[UTF8_STRING], &type,
-                             &format, &n_items, &bytes_after, (unsigned char **) &str) != Success) || (type == None))
+    if ((get_window_property (display_info, w, display_info->atoms[atom_id], G_MAXLONG,
+                              display_info->atoms[UTF8_STRING], &type, &format, &n_items,
+                              &bytes_after, (unsigned char **) &str) != Success) || (type == None))
     {
         TRACE ("no UTF8_STRING property found");
         return FALSE;
@@ -833,9 +1355,9 @@ getWindowProp (DisplayInfo *display_info, Window window, int atom_id, Window *w)
     g_return_val_if_fail (((atom_id >= 0) && (atom_id < ATOM_COUNT)), FALSE);
 
     *w = None;
-    if (XGetWindowProperty (display_info->dpy, window, display_info->atoms[atom_id],
-                            0L, 1L, FALSE, XA_WINDOW, &type, &format, &nitems,
-                            &bytes_after, (unsigned char **) &prop) == Success)
+    if (get_window_property (display_info, window, display_info->atoms[atom_id], 1L, XA_WINDOW,
+                             &type, &format, &nitems, &bytes_after,
+                             (unsigned char **) &prop) == Success)
     {
         if (prop)
         {
@@ -920,7 +1442,7 @@ getWindowRole (DisplayInfo *display_info, Window window, gchar **role)
     *role = NULL;
     g_return_val_if_fail (window != None, FALSE);
 
-    if (XGetTextProperty (display_info->dpy, window, &tp, display_info->atoms[WM_WINDOW_ROLE]))
+    if (get_xtext_property (display_info, window, display_info->atoms[WM_WINDOW_ROLE], &tp))
     {
         if (tp.value)
         {
@@ -963,9 +1485,9 @@ getNetWMUserTime (DisplayInfo *display_info, Window window, guint32 *timestamp)
 
     g_return_val_if_fail (window != None, FALSE);
 
-    if (XGetWindowProperty (display_info->dpy, window, display_info->atoms[NET_WM_USER_TIME],
-                            0L, 1L, FALSE, XA_CARDINAL, &actual_type, &actual_format, &nitems,
-                            &bytes_after, (unsigned char **) &data) == Success)
+    if (get_window_property (display_info, window, display_info->atoms[NET_WM_USER_TIME], 1L,
+                             XA_CARDINAL, &actual_type, &actual_format, &nitems,
+                             &bytes_after, (unsigned char **) &data) == Success)
     {
         if ((data) && (actual_type == XA_CARDINAL)
             && (nitems == 1) && (bytes_after == 0))
@@ -1010,7 +1532,7 @@ getClientID (DisplayInfo *display_info, Window window, gchar **client_id)
 
     if (getWindowProp (display_info, window, WM_CLIENT_LEADER, &id) && (id != None))
     {
-        if (XGetTextProperty (display_info->dpy, id, &tp, display_info->atoms[SM_CLIENT_ID]))
+        if (get_xtext_property (display_info, id, display_info->atoms[SM_CLIENT_ID], &tp))
         {
             if (tp.encoding == XA_STRING && tp.format == 8 && tp.nitems != 0)
             {
@@ -1060,9 +1582,9 @@ getKDEIcon (DisplayInfo *display_info, Window window, Pixmap * pixmap, Pixmap *
     *mask = None;
 
     icons = NULL;
-    if (XGetWindowProperty (display_info->dpy, window, display_info->atoms[KWM_WIN_ICON],
-                            0L, G_MAXLONG, FALSE, display_info->atoms[KWM_WIN_ICON], &type,
-                            &format, &nitems, &bytes_after, (unsigned char **)&data) != Success)
+    if (get_window_property (display_info, window, display_info->atoms[KWM_WIN_ICON], G_MAXLONG,
+                             display_info->atoms[KWM_WIN_ICON], &type, &format, &nitems,
+                             &bytes_after, (unsigned char **)&data) != Success)
     {
         return FALSE;
     }
@@ -1091,9 +1613,9 @@ getRGBIconData (DisplayInfo *display_info, Window window, unsigned long **data,
     int format;
     unsigned long bytes_after;
 
-    if (XGetWindowProperty (display_info->dpy, window, display_info->atoms[NET_WM_ICON],
-                            0L, G_MAXLONG, FALSE, XA_CARDINAL, &type, &format, nitems,
-                            &bytes_after, (unsigned char **) data) != Success)
+    if (get_window_property (display_info, window, display_info->atoms[NET_WM_ICON], G_MAXLONG,
+                             XA_CARDINAL, &type, &format, nitems, &bytes_after,
+                             (unsigned char **) data) != Success)
     {
         *data = NULL;
         return FALSE;
@@ -1239,9 +1761,10 @@ checkKdeSystrayWindow (DisplayInfo *display_info, Window window)
     TRACE ("entering checkKdeSystrayWindow");
     g_return_val_if_fail (window != None, FALSE);
 
-    XGetWindowProperty(display_info->dpy, window, display_info->atoms[KDE_NET_WM_SYSTEM_TRAY_WINDOW_FOR],
-                       0L, sizeof(Window), FALSE, XA_WINDOW, &actual_type, &actual_format,
-                       &nitems, &bytes_after, (unsigned char **) &data);
+    get_window_property (display_info, window,
+                         display_info->atoms[KDE_NET_WM_SYSTEM_TRAY_WINDOW_FOR], sizeof(Window),
+                         XA_WINDOW, &actual_type, &actual_format, &nitems, &bytes_after,
+                         (unsigned char **) &data);
 
     trayIconForWindow = None;
     if (data)
@@ -82,6 +82,7 @@
 #define WIN_LAYER_DOCK                          8
 #define WIN_LAYER_ABOVE_DOCK                    10
 #define WIN_LAYER_FULLSCREEN                    12
+#define WIN_LAYER_COUNT                         (WIN_LAYER_FULLSCREEN + 1)
 
 #define NET_WM_MOVERESIZE_SIZE_TOPLEFT          0
 #define NET_WM_MOVERESIZE_SIZE_TOP              1
@@ -213,6 +214,18 @@ void                     getTransientFor                        (DisplayInfo *,
                                                                  Window,
                                                                  Window,
                                                                  Window *);
+XWMHints                *getWMHints                             (DisplayInfo *,
+                                                                 Window);
+gboolean                 getWMNormalHints                       (DisplayInfo *,
+                                                                 Window,
+                                                                 XSizeHints *);
+gboolean                 getClassHint                           (DisplayInfo *,
+                                                                 Window,
+                                                                 XClassHint *);
+gboolean                 getWMColormapWindows                   (DisplayInfo *,
+                                                                 Window,
+                                                                 Window **,
+                                                                 int *);
 gboolean                 getWindowName                          (DisplayInfo *,
                                                                  Window,
                                                                  gchar **);
@@ -273,6 +286,14 @@ gboolean                 setAtomIdManagerOwner                  (DisplayInfo *,
                                                                  Window);
 void                     updateXserverTime                      (DisplayInfo *);
 guint32                  getXServerTime                         (DisplayInfo *);
+void                     prefetchWindowProperty                 (DisplayInfo *,
+                                                                 Window,
+                                                                 Atom);
+void                     prefetchClientProperties               (DisplayInfo *,
+                                                                 Window);
+void                     discardPrefetchedProperties            (DisplayInfo *,
+                                                                 Window);
+void                     discardAllPrefetchedProperties         (DisplayInfo *);
 
 #ifdef ENABLE_KDE_SYSTRAY_PROXY
 gboolean                 checkKdeSystrayWindow                  (DisplayInfo *,
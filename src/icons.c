@@ -523,7 +523,7 @@ getAppIcon (DisplayInfo *display_info, Window window, int width, int height)
     }
 
     gdk_error_trap_push ();
-    hints = XGetWMHints (display_info->dpy, window);
+    hints = getWMHints (display_info, window);
     gdk_error_trap_pop ();
 
     if (hints)
@@ -62,6 +62,7 @@
 #include "startup_notification.h"
 #include "compositor.h"
 #include "spinning_cursor.h"
+#include "stats.h"
 
 #define BASE_EVENT_MASK \
     SubstructureNotifyMask|\
@@ -157,6 +158,7 @@ cleanUp (void)
     }
     sn_close_display ();
     sessionFreeWindowStates ();
+    statsClose (main_display_info);
 
     myDisplayClose (main_display_info);
     g_free (main_display_info);
@@ -518,6 +520,7 @@ initialize (gint compositor_mode, gboolean replace_wm)
     main_display_info->xfilter = eventFilterInit ((gpointer) main_display_info);
     eventFilterPush (main_display_info->xfilter, xfwm4_event_filter, (gpointer) main_display_info);
     initPerDisplayCallbacks (main_display_info);
+    statsInit (main_display_info);
 
     return sessionStart (main_display_info);
 }
@@ -43,6 +43,7 @@
 #include "mywindow.h"
 #include "client.h"
 #include "misc.h"
+#include "stats.h"
 
 unsigned int
 getMouseXY (ScreenInfo *screen_info, Window w, int *x2, int *y2)
@@ -53,6 +54,7 @@ getMouseXY (ScreenInfo *screen_info, Window w, int *x2, int *y2)
 
     TRACE ("entering getMouseXY");
 
+    statsCount (STATS_QUERY_POINTER);
     XQueryPointer (myScreenGetXDisplay (screen_info), w, &w1, &w2, &x1, &y1, x2, y2, &mask);
     return mask;
 }
@@ -66,6 +68,7 @@ getMouseWindow (ScreenInfo *screen_info, Window w)
 
     TRACE ("entering getMouseWindow");
 
+    statsCount (STATS_QUERY_POINTER);
     XQueryPointer (myScreenGetXDisplay (screen_info), w, &w1, &w2, &x1, &y1, &x2, &y2, &mask);
     return w2;
 }
@@ -262,3 +265,62 @@ get_atom_name (DisplayInfo *display_info, Atom atom)
     return value;
 }
 
+/*
+ * Multimaps are plain GHashTables holding, for each key, the GSList of
+ * the values filed under that key. The lists belong to the table, the
+ * values are left to the caller.
+ */
+void
+multimapInsert (GHashTable *map, gpointer key, gpointer value)
+{
+    GSList *entries;
+
+    entries = (GSList *) g_hash_table_lookup (map, key);
+    entries = g_slist_prepend (entries, value);
+    g_hash_table_insert (map, key, entries);
+}
+
+void
+multimapRemove (GHashTable *map, gpointer key, gpointer value)
+{
+    GSList *entries;
+
+    entries = (GSList *) g_hash_table_lookup (map, key);
+    entries = g_slist_remove (entries, value);
+    if (entries)
+    {
+        g_hash_table_insert (map, key, entries);
+    }
+    else
+    {
+        g_hash_table_remove (map, key);
+    }
+}
+
+GSList *
+multimapLookup (GHashTable *map, gconstpointer key)
+{
+    return (GSList *) g_hash_table_lookup (map, key);
+}
+
+static void
+multimapFreeEntries (gpointer key, gpointer value, gpointer user_data)
+{
+    g_slist_free ((GSList *) value);
+}
+
+void
+multimapDestroy (GHashTable *map)
+{
+    g_hash_table_foreach (map, multimapFreeEntries, NULL);
+    g_hash_table_destroy (map);
+}
+
+gint64
+getCurrentTimeUsec (void)
+{
+    GTimeVal tv;
+
+    g_get_current_time (&tv);
+    return (gint64) tv.tv_sec * G_USEC_PER_SEC + tv.tv_usec;
+}
@@ -72,5 +72,15 @@ void                     placeSidewalks                         (ScreenInfo *,
                                                                  gboolean);
 gchar*                   get_atom_name                          (DisplayInfo *,
                                                                  Atom);
+void                     multimapInsert                         (GHashTable *,
+                                                                 gpointer,
+                                                                 gpointer);
+void                     multimapRemove                         (GHashTable *,
+                                                                 gpointer,
+                                                                 gpointer);
+GSList                  *multimapLookup                         (GHashTable *,
+                                                                 gconstpointer);
+void                     multimapDestroy                        (GHashTable *);
+gint64                   getCurrentTimeUsec                     (void);
 
 #endif /* INC_MISC_H */
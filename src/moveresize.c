@@ -47,6 +47,7 @@
 #include "transients.h"
 #include "event_filter.h"
 #include "workspaces.h"
+#include "misc.h"
 #include "xsync.h"
 
 #define MOVERESIZE_EVENT_MASK \
@@ -57,6 +58,40 @@
 
 #define TILE_DISTANCE 2
 
+/*
+ * Edges of the windows that a moved or resized window can snap to,
+ * taken at the beginning of the operation and sorted by position so
+ * that only the edges within the snap range are looked at.
+ */
+typedef struct _SnapWindow SnapWindow;
+struct _SnapWindow
+{
+    gint x, y;
+    gint width, height;
+    gint frame_x, frame_y;
+    gint frame_width, frame_height;
+};
+
+typedef struct _SnapEdge SnapEdge;
+struct _SnapEdge
+{
+    gint pos;
+    guint order; /* Position of the window in the clients list */
+    SnapWindow *win;
+};
+
+typedef struct _SnapEdges SnapEdges;
+struct _SnapEdges
+{
+    guint workspace;
+    guint count;
+    SnapWindow *windows;
+    SnapEdge *left;
+    SnapEdge *right;
+    SnapEdge *top;
+    SnapEdge *bottom;
+};
+
 typedef struct _MoveResizeData MoveResizeData;
 struct _MoveResizeData
 {
@@ -77,6 +112,7 @@ struct _MoveResizeData
     gint oldw, oldh;
     gint handle;
     Poswin *poswin;
+    SnapEdges edges;
 };
 
 static void
@@ -344,22 +380,66 @@ clientCheckOverlap (int s1, int e1, int s2, int e2)
     return FALSE;
 }
 
-static int
-clientFindClosestEdgeX (Client *c, int edge_pos)
+static gint
+snapEdgeCompare (gconstpointer a, gconstpointer b, gpointer data)
 {
-    /* Find the closest edge of anything that we can snap to, taking
-       frames into account, or just return the original value if nothing
-       is within the snapping range. -Cliff */
+    const SnapEdge *e1 = (const SnapEdge *) a;
+    const SnapEdge *e2 = (const SnapEdge *) b;
 
-    Client *c2;
+    if (e1->pos != e2->pos)
+    {
+        return (e1->pos < e2->pos) ? -1 : 1;
+    }
+    if (e1->order != e2->order)
+    {
+        return (e1->order < e2->order) ? -1 : 1;
+    }
+    return 0;
+}
+
+static void
+snapEdgeSet (SnapEdge *edge, gint pos, guint order, SnapWindow *win)
+{
+    edge->pos = pos;
+    edge->order = order;
+    edge->win = win;
+}
+
+static void
+clientFreeSnapEdges (SnapEdges *edges)
+{
+    g_free (edges->windows);
+    g_free (edges->left);
+    g_free (edges->right);
+    g_free (edges->top);
+    g_free (edges->bottom);
+    edges->windows = NULL;
+    edges->left = NULL;
+    edges->right = NULL;
+    edges->top = NULL;
+    edges->bottom = NULL;
+    edges->count = 0;
+}
+
+static void
+clientBuildSnapEdges (Client *c, SnapEdges *edges)
+{
     ScreenInfo *screen_info;
-    guint i;
-    int snap_width, closest;
+    SnapWindow *win;
+    Client *c2;
+    guint i, n;
 
-    screen_info = c->screen_info;
-    snap_width = screen_info->params->snap_width;
-    closest = edge_pos + snap_width + 2; /* This only needs to be out of the snap range to work. -Cliff */
+    TRACE ("entering clientBuildSnapEdges");
 
+    screen_info = c->screen_info;
+    edges->workspace = screen_info->current_ws;
+    edges->windows = g_new (SnapWindow, screen_info->client_count + 1);
+    edges->left = g_new (SnapEdge, screen_info->client_count + 1);
+    edges->right = g_new (SnapEdge, screen_info->client_count + 1);
+    edges->top = g_new (SnapEdge, screen_info->client_count + 1);
+    edges->bottom = g_new (SnapEdge, screen_info->client_count + 1);
+
+    n = 0;
     for (c2 = screen_info->clients, i = 0; i < screen_info->client_count; c2 = c2->next, i++)
     {
         if (FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE)  && (c2 != c) &&
@@ -368,82 +448,189 @@ clientFindClosestEdgeX (Client *c, int edge_pos)
                   && FLAG_TEST (c2->flags, CLIENT_FLAG_HAS_STRUT)
                   && FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE))))
         {
+            win = &edges->windows[n];
+            win->x = c2->x;
+            win->y = c2->y;
+            win->width = c2->width;
+            win->height = c2->height;
+            win->frame_x = frameX (c2);
+            win->frame_y = frameY (c2);
+            win->frame_width = frameWidth (c2);
+            win->frame_height = frameHeight (c2);
+
+            snapEdgeSet (&edges->left[n], win->frame_x, i, win);
+            snapEdgeSet (&edges->right[n], win->frame_x + win->frame_width, i, win);
+            snapEdgeSet (&edges->top[n], win->frame_y, i, win);
+            snapEdgeSet (&edges->bottom[n], win->frame_y + win->frame_height, i, win);
+            n++;
+        }
+    }
+    edges->count = n;
+    TRACE ("%u window(s) to snap to", n);
+
+    g_qsort_with_data (edges->left, n, sizeof (SnapEdge), snapEdgeCompare, NULL);
+    g_qsort_with_data (edges->right, n, sizeof (SnapEdge), snapEdgeCompare, NULL);
+    g_qsort_with_data (edges->top, n, sizeof (SnapEdge), snapEdgeCompare, NULL);
+    g_qsort_with_data (edges->bottom, n, sizeof (SnapEdge), snapEdgeCompare, NULL);
+}
 
-            if (clientCheckOverlap (c->y - frameTop (c) - 1, c->y + c->height + frameBottom (c) + 1, c2->y - frameTop (c) - 1, c2->y + c2->height + frameBottom (c) + 1))
-            {
-                if (abs (c2->x - frameLeft (c2) - edge_pos) < abs (closest - edge_pos))
-                {
-                    closest = c2->x - frameLeft (c2);
-                }
-                if (abs ((c2->x + c2->width) + frameRight (c2) - edge_pos) < abs (closest - edge_pos))
-                {
-                    closest = (c2->x + c2->width) + frameRight (c2);
-                }
-            }
+static void
+clientCheckSnapEdges (Client *c, SnapEdges *edges)
+{
+    /* Windows shown and hidden when switching workspace while moving */
+    if (edges->workspace != c->screen_info->current_ws)
+    {
+        clientFreeSnapEdges (edges);
+        clientBuildSnapEdges (c, edges);
+    }
+}
+
+/* Index of the first edge at or after the given position */
+static guint
+snapEdgesLowerBound (SnapEdge *array, guint count, gint pos)
+{
+    guint low, high, mid;
+
+    low = 0;
+    high = count;
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (array[mid].pos < pos)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
         }
     }
 
-    if (abs (closest - edge_pos) > snap_width)
+    return low;
+}
+
+/*
+ * Windows are compared in the order of the clients list, and for each
+ * window the edges are checked in a given order (rank), the first edge
+ * found at the smallest distance wins.
+ */
+static gboolean
+snapEdgeIsBetter (SnapEdge *edge, guint rank, gint delta,
+                  SnapEdge *best, guint best_rank, gint best_delta)
+{
+    if (delta != best_delta)
     {
-        closest = edge_pos;
+        return (delta < best_delta);
+    }
+    if (!best)
+    {
+        return FALSE;
+    }
+    return ((edge->order < best->order) ||
+            ((edge->order == best->order) && (rank < best_rank)));
+}
+
+static int
+clientFindClosestEdgeX (Client *c, SnapEdges *edges, int edge_pos)
+{
+    /* Find the closest edge of anything that we can snap to, taking
+       frames into account, or just return the original value if nothing
+       is within the snapping range. -Cliff */
+
+    ScreenInfo *screen_info;
+    SnapEdge *lists[2];
+    SnapEdge *best;
+    SnapWindow *w;
+    guint i, j, best_rank;
+    int snap_width, closest, delta, best_delta;
+
+    screen_info = c->screen_info;
+    snap_width = screen_info->params->snap_width;
+    closest = edge_pos;
+    best = NULL;
+    best_rank = 0;
+    best_delta = snap_width + 1;
+
+    clientCheckSnapEdges (c, edges);
+    lists[0] = edges->left;
+    lists[1] = edges->right;
+
+    for (j = 0; j < 2; j++)
+    {
+        for (i = snapEdgesLowerBound (lists[j], edges->count, edge_pos - snap_width);
+             (i < edges->count) && (lists[j][i].pos <= edge_pos + snap_width); i++)
+        {
+            w = lists[j][i].win;
+            delta = abs (lists[j][i].pos - edge_pos);
+            if (snapEdgeIsBetter (&lists[j][i], j, delta, best, best_rank, best_delta) &&
+                clientCheckOverlap (c->y - frameTop (c) - 1, c->y + c->height + frameBottom (c) + 1,
+                                    w->y - frameTop (c) - 1, w->y + w->height + frameBottom (c) + 1))
+            {
+                best = &lists[j][i];
+                best_rank = j;
+                best_delta = delta;
+                closest = best->pos;
+            }
+        }
     }
 
     return closest;
 }
 
 static int
-clientFindClosestEdgeY (Client *c, int edge_pos)
+clientFindClosestEdgeY (Client *c, SnapEdges *edges, int edge_pos)
 {
     /* This function is mostly identical to the one above, but swaps the
        axes. If there's a better way to do it than this, I'd like to
        know. -Cliff */
 
-    Client *c2;
     ScreenInfo *screen_info;
-    guint i;
-    int snap_width, closest;
+    SnapEdge *lists[2];
+    SnapEdge *best;
+    SnapWindow *w;
+    guint i, j, best_rank;
+    int snap_width, closest, delta, best_delta;
 
     screen_info = c->screen_info;
     snap_width = screen_info->params->snap_width;
-    closest = edge_pos + snap_width + 1; /* This only needs to be out of the snap range to work. -Cliff */
+    closest = edge_pos;
+    best = NULL;
+    best_rank = 0;
+    best_delta = snap_width + 1;
 
-    for (c2 = screen_info->clients, i = 0; i < screen_info->client_count; c2 = c2->next, i++)
+    clientCheckSnapEdges (c, edges);
+    lists[0] = edges->top;
+    lists[1] = edges->bottom;
+
+    for (j = 0; j < 2; j++)
     {
-        if (FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE)  && (c2 != c) &&
-            (((screen_info->params->snap_to_windows) && (c2->win_layer == c->win_layer))
-             || ((screen_info->params->snap_to_border)
-                  && FLAG_TEST (c2->flags, CLIENT_FLAG_HAS_STRUT)
-                  && FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE))))
+        for (i = snapEdgesLowerBound (lists[j], edges->count, edge_pos - snap_width);
+             (i < edges->count) && (lists[j][i].pos <= edge_pos + snap_width); i++)
         {
-
-            if (clientCheckOverlap (c->x - frameLeft (c) - 1, c->x + c->width + frameRight (c) + 1, c2->x - frameLeft (c) - 1, c2->x + c2->width + frameRight (c) + 1))
+            w = lists[j][i].win;
+            delta = abs (lists[j][i].pos - edge_pos);
+            if (snapEdgeIsBetter (&lists[j][i], j, delta, best, best_rank, best_delta) &&
+                clientCheckOverlap (c->x - frameLeft (c) - 1, c->x + c->width + frameRight (c) + 1,
+                                    w->x - frameLeft (c) - 1, w->x + w->width + frameRight (c) + 1))
             {
-                if (abs (c2->y - frameTop(c2) - edge_pos) < abs (closest - edge_pos))
-                {
-                    closest = c2->y - frameTop (c2);
-                }
-                if (abs ((c2->y + c2->height) + frameBottom (c2) - edge_pos) < abs (closest - edge_pos))
-                {
-                    closest = (c2->y + c2->height) + frameBottom (c2);
-                }
+                best = &lists[j][i];
+                best_rank = j;
+                best_delta = delta;
+                closest = best->pos;
             }
         }
     }
 
-    if (abs (closest - edge_pos) > snap_width)
-    {
-        closest = edge_pos;
-    }
-
     return closest;
 }
 
 static void
-clientSnapPosition (Client * c, int prev_x, int prev_y)
+clientSnapPosition (Client * c, SnapEdges *edges, int prev_x, int prev_y)
 {
     ScreenInfo *screen_info;
-    Client *c2;
-    guint i;
+    SnapEdge *edge, *best_x, *best_y;
+    SnapWindow *w;
+    guint i, best_rank_x, best_rank_y;
     int cx, cy, delta;
     int disp_x, disp_y, disp_max_x, disp_max_y;
     int frame_x, frame_y, frame_height, frame_width;
@@ -451,7 +638,8 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
     int frame_x2, frame_y2;
     int best_frame_x, best_frame_y;
     int best_delta_x, best_delta_y;
-    int c_frame_x1, c_frame_x2, c_frame_y1, c_frame_y2;
+    int snap_width;
+    gboolean snap_resist;
     GdkRectangle rect;
 
     g_return_if_fail (c != NULL);
@@ -459,8 +647,14 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
     TRACE ("Snapping client \"%s\" (0x%lx)", c->name, c->window);
 
     screen_info = c->screen_info;
-    best_delta_x = screen_info->params->snap_width + 1;
-    best_delta_y = screen_info->params->snap_width + 1;
+    snap_width = screen_info->params->snap_width;
+    snap_resist = screen_info->params->snap_resist;
+    best_delta_x = snap_width + 1;
+    best_delta_y = snap_width + 1;
+    best_x = NULL;
+    best_y = NULL;
+    best_rank_x = 0;
+    best_rank_y = 0;
 
     frame_x = frameX (c);
     frame_y = frameY (c);
@@ -488,7 +682,7 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
     {
         if (abs (disp_x - frame_x) < abs (disp_max_x - frame_x2))
         {
-            if (!screen_info->params->snap_resist || ((frame_x <= disp_x) && (c->x < prev_x)))
+            if (!snap_resist || ((frame_x <= disp_x) && (c->x < prev_x)))
             {
                 best_delta_x = abs (disp_x - frame_x);
                 best_frame_x = disp_x;
@@ -496,7 +690,7 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
         }
         else
         {
-            if (!screen_info->params->snap_resist || ((frame_x2 >= disp_max_x) && (c->x > prev_x)))
+            if (!snap_resist || ((frame_x2 >= disp_max_x) && (c->x > prev_x)))
             {
                 best_delta_x = abs (disp_max_x - frame_x2);
                 best_frame_x = disp_max_x - frame_width;
@@ -505,7 +699,7 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
 
         if (abs (disp_y - frame_y) < abs (disp_max_y - frame_y2))
         {
-            if (!screen_info->params->snap_resist || ((frame_y <= disp_y) && (c->y < prev_y)))
+            if (!snap_resist || ((frame_y <= disp_y) && (c->y < prev_y)))
             {
                 best_delta_y = abs (disp_y - frame_y);
                 best_frame_y = disp_y;
@@ -513,7 +707,7 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
         }
         else
         {
-            if (!screen_info->params->snap_resist || ((frame_y2 >= disp_max_y) && (c->y > prev_y)))
+            if (!snap_resist || ((frame_y2 >= disp_max_y) && (c->y > prev_y)))
             {
                 best_delta_y = abs (disp_max_y - frame_y2);
                 best_frame_y = disp_max_y - frame_height;
@@ -521,72 +715,85 @@ clientSnapPosition (Client * c, int prev_x, int prev_y)
         }
     }
 
-    for (c2 = screen_info->clients, i = 0; i < screen_info->client_count; c2 = c2->next, i++)
+    clientCheckSnapEdges (c, edges);
+
+    /* Right edges of other windows to the left side of the window */
+    for (i = snapEdgesLowerBound (edges->right, edges->count, frame_x - snap_width);
+         (i < edges->count) && (edges->right[i].pos <= frame_x + snap_width); i++)
     {
-        if (FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE)  && (c2 != c) &&
-            (((screen_info->params->snap_to_windows) && (c2->win_layer == c->win_layer))
-             || ((screen_info->params->snap_to_border)
-                  && FLAG_TEST (c2->flags, CLIENT_FLAG_HAS_STRUT)
-                  && FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE))))
+        edge = &edges->right[i];
+        w = edge->win;
+        delta = abs (edge->pos - frame_x);
+        if (snapEdgeIsBetter (edge, 0, delta, best_x, best_rank_x, best_delta_x) &&
+            (w->frame_y <= frame_y2) && (w->frame_y + w->frame_height >= frame_y) &&
+            (!snap_resist || ((frame_x <= edge->pos) && (c->x < prev_x))))
         {
-            c_frame_x1 = frameX (c2);
-            c_frame_x2 = c_frame_x1 + frameWidth (c2);
-            c_frame_y1 = frameY (c2);
-            c_frame_y2 = c_frame_y1 + frameHeight (c2);
-
-            if ((c_frame_y1 <= frame_y2) && (c_frame_y2 >= frame_y))
-            {
-                delta = abs (c_frame_x2 - frame_x);
-                if (delta < best_delta_x)
-                {
-                    if (!screen_info->params->snap_resist || ((frame_x <= c_frame_x2) && (c->x < prev_x)))
-                    {
-                        best_delta_x = delta;
-                        best_frame_x = c_frame_x2;
-                    }
-                }
+            best_x = edge;
+            best_rank_x = 0;
+            best_delta_x = delta;
+            best_frame_x = edge->pos;
+        }
+    }
 
-                delta = abs (c_frame_x1 - frame_x2);
-                if (delta < best_delta_x)
-                {
-                    if (!screen_info->params->snap_resist || ((frame_x2 >= c_frame_x1) && (c->x > prev_x)))
-                    {
-                        best_delta_x = delta;
-                        best_frame_x = c_frame_x1 - frame_width;
-                    }
-                }
-            }
+    /* Left edges of other windows to the right side of the window */
+    for (i = snapEdgesLowerBound (edges->left, edges->count, frame_x2 - snap_width);
+         (i < edges->count) && (edges->left[i].pos <= frame_x2 + snap_width); i++)
+    {
+        edge = &edges->left[i];
+        w = edge->win;
+        delta = abs (edge->pos - frame_x2);
+        if (snapEdgeIsBetter (edge, 1, delta, best_x, best_rank_x, best_delta_x) &&
+            (w->frame_y <= frame_y2) && (w->frame_y + w->frame_height >= frame_y) &&
+            (!snap_resist || ((frame_x2 >= edge->pos) && (c->x > prev_x))))
+        {
+            best_x = edge;
+            best_rank_x = 1;
+            best_delta_x = delta;
+            best_frame_x = edge->pos - frame_width;
+        }
+    }
 
-            if ((c_frame_x1 <= frame_x2) && (c_frame_x2 >= frame_x))
-            {
-                delta = abs (c_frame_y2 - frame_y);
-                if (delta < best_delta_y)
-                {
-                    if (!screen_info->params->snap_resist || ((frame_y <= c_frame_y2) && (c->y < prev_y)))
-                    {
-                        best_delta_y = delta;
-                        best_frame_y = c_frame_y2;
-                    }
-                }
+    /* Bottom edges of other windows to the top side of the window */
+    for (i = snapEdgesLowerBound (edges->bottom, edges->count, frame_y - snap_width);
+         (i < edges->count) && (edges->bottom[i].pos <= frame_y + snap_width); i++)
+    {
+        edge = &edges->bottom[i];
+        w = edge->win;
+        delta = abs (edge->pos - frame_y);
+        if (snapEdgeIsBetter (edge, 0, delta, best_y, best_rank_y, best_delta_y) &&
+            (w->frame_x <= frame_x2) && (w->frame_x + w->frame_width >= frame_x) &&
+            (!snap_resist || ((frame_y <= edge->pos) && (c->y < prev_y))))
+        {
+            best_y = edge;
+            best_rank_y = 0;
+            best_delta_y = delta;
+            best_frame_y = edge->pos;
+        }
+    }
 
-                delta = abs (c_frame_y1 - frame_y2);
-                if (delta < best_delta_y)
-                {
-                    if (!screen_info->params->snap_resist || ((frame_y2 >= c_frame_y1) && (c->y > prev_y)))
-                    {
-                        best_delta_y = delta;
-                        best_frame_y = c_frame_y1 - frame_height;
-                    }
-                }
-            }
+    /* Top edges of other windows to the bottom side of the window */
+    for (i = snapEdgesLowerBound (edges->top, edges->count, frame_y2 - snap_width);
+         (i < edges->count) && (edges->top[i].pos <= frame_y2 + snap_width); i++)
+    {
+        edge = &edges->top[i];
+        w = edge->win;
+        delta = abs (edge->pos - frame_y2);
+        if (snapEdgeIsBetter (edge, 1, delta, best_y, best_rank_y, best_delta_y) &&
+            (w->frame_x <= frame_x2) && (w->frame_x + w->frame_width >= frame_x) &&
+            (!snap_resist || ((frame_y2 >= edge->pos) && (c->y > prev_y))))
+        {
+            best_y = edge;
+            best_rank_y = 1;
+            best_delta_y = delta;
+            best_frame_y = edge->pos - frame_height;
         }
     }
 
-    if (best_delta_x <= screen_info->params->snap_width)
+    if (best_delta_x <= snap_width)
     {
         c->x = best_frame_x + frame_left;
     }
-    if (best_delta_y <= screen_info->params->snap_width)
+    if (best_delta_y <= snap_width)
     {
         c->y = best_frame_y + frame_top;
     }
@@ -996,7 +1203,7 @@ clientMoveEventFilter (XEvent * xevent, gpointer data)
         c->x = passdata->ox + (xevent->xmotion.x_root - passdata->mx);
         c->y = passdata->oy + (xevent->xmotion.y_root - passdata->my);
 
-        clientSnapPosition (c, prev_x, prev_y);
+        clientSnapPosition (c, &passdata->edges, prev_x, prev_y);
         if (screen_info->params->restore_on_move && toggled_maximize)
         {
             if ((clientConstrainPos (c, FALSE) & CLIENT_CONSTRAINED_TOP) &&
@@ -1161,6 +1368,8 @@ clientMove (Client * c, XEvent * ev)
     /* Clear any previously saved pos flag from screen resize */
     FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_SAVED_POS);
 
+    clientBuildSnapEdges (c, &passdata.edges);
+
     FLAG_SET (c->xfwm_flags, XFWM_FLAG_MOVING_RESIZING);
     TRACE ("entering move loop");
     eventFilterPush (display_info->xfilter, clientMoveEventFilter, &passdata);
@@ -1169,6 +1378,8 @@ clientMove (Client * c, XEvent * ev)
     TRACE ("leaving move loop");
     FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_MOVING_RESIZING);
 
+    clientFreeSnapEdges (&passdata.edges);
+
     /* Put back the sidewalks as they ought to be */
     placeSidewalks (screen_info, screen_info->params->wrap_workspaces);
 
@@ -1243,35 +1454,101 @@ clientChangeHandle(MoveResizeData *passdata, int handle)
 }
 
 static void
-clientResizeConfigure (Client *c, int px, int py, int pw, int ph)
+clientResizeDoConfigure (Client *c)
 {
-    ScreenInfo *screen_info;
-    DisplayInfo *display_info;
     XWindowChanges wc;
 
-    screen_info = c->screen_info;
-    display_info = screen_info->display_info;
+#ifdef HAVE_XSYNC
+    if ((c->screen_info->display_info->have_xsync) && (c->xsync_enabled) && (c->xsync_counter))
+    {
+        clientXSyncRequest (c);
+    }
+#endif /* HAVE_XSYNC */
+    wc.x = c->x;
+    wc.y = c->y;
+    wc.width = c->width;
+    wc.height = c->height;
+    clientConfigure (c, &wc, CWX | CWY | CWWidth | CWHeight, NO_CFG_FLAG);
+
+    c->resize_time = getCurrentTimeUsec ();
+    c->resize_pending = FALSE;
+}
+
+static void
+clientResizeClearTimeout (Client *c)
+{
+    if (c->resize_timeout_id)
+    {
+        g_source_remove (c->resize_timeout_id);
+        c->resize_timeout_id = 0;
+    }
+}
+
+static gboolean
+clientResizeTimeout (gpointer data)
+{
+    Client *c;
+
+    TRACE ("entering clientResizeTimeout");
+
+    c = (Client *) data;
+    c->resize_timeout_id = 0;
+    clientResizeConfigurePending (c);
+
+    return (FALSE);
+}
+
+/*
+ * Configure the window being resized, at the pace the client can
+ * follow: clients supporting XSync get the next size as soon as they
+ * have redrawn for the previous one, other clients no more often than
+ * every CLIENT_RESIZE_INTERVAL. Sizes that cannot be sent right away
+ * are not lost, the latest one is sent when the client is ready.
+ */
+static void
+clientResizeConfigure (Client *c, int px, int py, int pw, int ph)
+{
+    gint64 elapsed;
 
 #ifdef HAVE_XSYNC
     if (c->xsync_waiting)
     {
+        c->resize_pending = TRUE;
         return;
     }
-    else
+    if ((c->screen_info->display_info->have_xsync) && (c->xsync_enabled) && (c->xsync_counter))
     {
-        if ((display_info->have_xsync) && (c->xsync_enabled) && (c->xsync_counter))
+        clientResizeDoConfigure (c);
+        return;
+    }
+#endif /* HAVE_XSYNC */
+
+    elapsed = getCurrentTimeUsec () - c->resize_time;
+    if ((elapsed >= 0) && (elapsed < CLIENT_RESIZE_INTERVAL * 1000))
+    {
+        c->resize_pending = TRUE;
+        if (c->resize_timeout_id == 0)
         {
-            clientXSyncRequest (c);
+            c->resize_timeout_id = g_timeout_add (CLIENT_RESIZE_INTERVAL - (guint) (elapsed / 1000),
+                                                  clientResizeTimeout, c);
         }
-#endif /* HAVE_XSYNC */
-        wc.x = c->x;
-        wc.y = c->y;
-        wc.width = c->width;
-        wc.height = c->height;
-        clientConfigure (c, &wc, CWX | CWY | CWWidth | CWHeight, NO_CFG_FLAG);
-#ifdef HAVE_XSYNC
+        return;
+    }
+
+    clientResizeClearTimeout (c);
+    clientResizeDoConfigure (c);
+}
+
+void
+clientResizeConfigurePending (Client *c)
+{
+    g_return_if_fail (c != NULL);
+    TRACE ("entering clientResizeConfigurePending");
+
+    if ((c->resize_pending) && FLAG_TEST (c->xfwm_flags, XFWM_FLAG_MOVING_RESIZING))
+    {
+        clientResizeConfigure (c, c->x, c->y, c->width, c->height);
     }
-#endif /* HAVE_XSYNC */
 }
 
 static eventFilterStatus
@@ -1483,7 +1760,7 @@ clientResizeEventFilter (XEvent * xevent, gpointer data)
             c->width = passdata->ow + (xevent->xmotion.x_root - passdata->mx);
 
             /* Attempt to snap the right edge to something. -Cliff */
-            c->width = clientFindClosestEdgeX (c, c->x + c->width + frameRight (c)) - c->x - frameRight (c);
+            c->width = clientFindClosestEdgeX (c, &passdata->edges, c->x + c->width + frameRight (c)) - c->x - frameRight (c);
 
         }
         if (!FLAG_TEST (c->flags, CLIENT_FLAG_SHADED))
@@ -1497,7 +1774,7 @@ clientResizeEventFilter (XEvent * xevent, gpointer data)
                 c->height = passdata->oh + (xevent->xmotion.y_root - passdata->my);
 
                 /* Attempt to snap the bottom edge to something. -Cliff */
-                c->height = clientFindClosestEdgeY (c, c->y + c->height + frameBottom (c)) - c->y - frameBottom (c);
+                c->height = clientFindClosestEdgeY (c, &passdata->edges, c->y + c->height + frameBottom (c)) - c->y - frameBottom (c);
             }
         }
         clientConstrainRatio (c, passdata->handle);
@@ -1509,7 +1786,7 @@ clientResizeEventFilter (XEvent * xevent, gpointer data)
 
             /* Snap the left edge to something. -Cliff */
             right_edge = c->x + c->width;
-            c->x = clientFindClosestEdgeX (c, c->x - frameLeft (c)) + frameLeft (c);
+            c->x = clientFindClosestEdgeX (c, &passdata->edges, c->x - frameLeft (c)) + frameLeft (c);
             c->width = right_edge - c->x;
 
             frame_x = frameX (c);
@@ -1522,7 +1799,7 @@ clientResizeEventFilter (XEvent * xevent, gpointer data)
 
             /* Snap the top edge to something. -Cliff */
             bottom_edge = c->y + c->height;
-            c->y = clientFindClosestEdgeY (c, c->y - frameTop (c)) + frameTop (c);
+            c->y = clientFindClosestEdgeY (c, &passdata->edges, c->y - frameTop (c)) + frameTop (c);
             c->height = bottom_edge - c->y;
 
             frame_y = frameY (c);
@@ -1733,6 +2010,8 @@ clientResize (Client * c, int handle, XEvent * ev)
     /* Clear any previously saved pos flag from screen resize */
     FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_SAVED_POS);
 
+    clientBuildSnapEdges (c, &passdata.edges);
+
     FLAG_SET (c->xfwm_flags, XFWM_FLAG_MOVING_RESIZING);
     TRACE ("entering resize loop");
     eventFilterPush (display_info->xfilter, clientResizeEventFilter, &passdata);
@@ -1741,6 +2020,8 @@ clientResize (Client * c, int handle, XEvent * ev)
     TRACE ("leaving resize loop");
     FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_MOVING_RESIZING);
 
+    clientFreeSnapEdges (&passdata.edges);
+
     if (passdata.poswin)
     {
         poswinDestroy (passdata.poswin);
@@ -1763,6 +2044,8 @@ clientResize (Client * c, int handle, XEvent * ev)
     wc.width = c->width;
     wc.height = c->height;
     clientConfigure (c, &wc, CWX | CWY | CWHeight | CWWidth, NO_CFG_FLAG);
+    clientResizeClearTimeout (c);
+    c->resize_pending = FALSE;
 #ifdef HAVE_XSYNC
     clientXSyncClearTimeout (c);
     c->xsync_waiting = FALSE;
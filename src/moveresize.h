@@ -44,5 +44,6 @@ void                     clientMove                             (Client *,
 void                     clientResize                           (Client *,
                                                                  int,
                                                                  XEvent *);
+void                     clientResizeConfigurePending           (Client *);
 
 #endif /* INC_MOVERESIZE_H */
@@ -49,6 +49,10 @@
 #include "mypixmap.h"
 #include "xpm-color-table.h"
 
+/* Theme atlas geometry, X pixmaps cannot exceed 32767 pixels */
+#define ATLAS_MIN_WIDTH  512
+#define ATLAS_MAX_HEIGHT 32767
+
 enum buf_op
 {
     op_header,
@@ -791,6 +795,59 @@ xfwmPixmapCompose (GdkPixbuf *pixbuf, const gchar * dir, const gchar * file)
     return pixbuf;
 }
 
+static GdkRegion *
+xfwmPixmapShapeFromGdkPixbuf (GdkPixbuf *pixbuf, gint width, gint height, gint alpha_threshold)
+{
+    GdkRegion *shape;
+    GdkRectangle rect;
+    guchar *pixels, *src;
+    gint rowstride, n_channels;
+    gint x, y;
+
+    shape = gdk_region_new ();
+    if (!gdk_pixbuf_get_has_alpha (pixbuf))
+    {
+        rect.x = 0;
+        rect.y = 0;
+        rect.width = width;
+        rect.height = height;
+        gdk_region_union_with_rect (shape, &rect);
+        return shape;
+    }
+
+    rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+    n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+    pixels = gdk_pixbuf_get_pixels (pixbuf);
+
+    rect.height = 1;
+    for (y = 0; y < height; y++)
+    {
+        src = pixels + y * rowstride + 3;
+        x = 0;
+        while (x < width)
+        {
+            /* Skip the transparent pixels, then add the run of opaque ones */
+            while ((x < width) && (src[x * n_channels] < alpha_threshold))
+            {
+                x++;
+            }
+            rect.x = x;
+            while ((x < width) && (src[x * n_channels] >= alpha_threshold))
+            {
+                x++;
+            }
+            if (x > rect.x)
+            {
+                rect.y = y;
+                rect.width = x - rect.x;
+                gdk_region_union_with_rect (shape, &rect);
+            }
+        }
+    }
+
+    return shape;
+}
+
 static gboolean
 xfwmPixmapDrawFromGdkPixbuf (xfwmPixmap * pm, GdkPixbuf *pixbuf)
 {
@@ -864,6 +921,20 @@ xfwmPixmapDrawFromGdkPixbuf (xfwmPixmap * pm, GdkPixbuf *pixbuf)
                                        0, 0, dest_x, dest_y,
                                        width, height, alpha_threshold);
 
+    /*
+     * Keep the same mask as a region, unless part of the bitmap is left
+     * undefined or the pixmap does not track its shape at all.
+     */
+    if (pm->shape)
+    {
+        gdk_region_destroy (pm->shape);
+        pm->shape = NULL;
+        if ((width == pm->width) && (height == pm->height))
+        {
+            pm->shape = xfwmPixmapShapeFromGdkPixbuf (pixbuf, width, height, alpha_threshold);
+        }
+    }
+
     g_object_unref (cmap);
     g_object_unref (dest_pixmap);
     g_object_unref (dest_bitmap);
@@ -871,8 +942,8 @@ xfwmPixmapDrawFromGdkPixbuf (xfwmPixmap * pm, GdkPixbuf *pixbuf)
     return TRUE;
 }
 
-gboolean
-xfwmPixmapRenderGdkPixbuf (xfwmPixmap * pm, GdkPixbuf *pixbuf)
+static gboolean
+xfwmPixmapDrawGdkPixbufOver (xfwmPixmap * pm, GdkPixbuf *pixbuf)
 {
     GdkPixbuf *src;
     GdkPixmap *destw;
@@ -932,20 +1003,165 @@ xfwmPixmapRenderGdkPixbuf (xfwmPixmap * pm, GdkPixbuf *pixbuf)
     return TRUE;
 }
 
+#ifdef HAVE_RENDER
+static Picture
+xfwmPixmapUploadGdkPixbuf (ScreenInfo * screen_info, GdkPixbuf *pixbuf, Pixmap *pixmap)
+{
+    Display *dpy;
+    XRenderPictFormat *format;
+    XImage *image;
+    Picture pict;
+    GC gc;
+    guint32 *data, *dest;
+    guchar *pixels, *src;
+    gint width, height, rowstride, n_channels;
+    gint x, y;
+    guint a;
+
+    dpy = myScreenGetXDisplay (screen_info);
+    *pixmap = None;
+
+    format = XRenderFindStandardFormat (dpy, PictStandardARGB32);
+    if (!format)
+    {
+        return None;
+    }
+
+    width = gdk_pixbuf_get_width (pixbuf);
+    height = gdk_pixbuf_get_height (pixbuf);
+    rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+    n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+    pixels = gdk_pixbuf_get_pixels (pixbuf);
+
+    /* XRender wants premultiplied ARGB */
+    data = g_new (guint32, width * height);
+    for (y = 0, dest = data; y < height; y++)
+    {
+        src = pixels + y * rowstride;
+        for (x = 0; x < width; x++, src += n_channels, dest++)
+        {
+            a = gdk_pixbuf_get_has_alpha (pixbuf) ? src[3] : 0xff;
+            *dest = (a << 24) |
+                    (((src[0] * a + 127) / 255) << 16) |
+                    (((src[1] * a + 127) / 255) << 8) |
+                     ((src[2] * a + 127) / 255);
+        }
+    }
+
+    image = XCreateImage (dpy, NULL, 32, ZPixmap, 0, (char *) data,
+                          width, height, 32, width * 4);
+    if (!image)
+    {
+        g_free (data);
+        return None;
+    }
+    /* The data is in host order, let Xlib swap it if needed */
+    image->byte_order = (G_BYTE_ORDER == G_LITTLE_ENDIAN) ? LSBFirst : MSBFirst;
+
+    *pixmap = XCreatePixmap (dpy, screen_info->xroot, width, height, 32);
+    gc = XCreateGC (dpy, *pixmap, 0, NULL);
+    XPutImage (dpy, *pixmap, gc, image, 0, 0, 0, 0, width, height);
+    XFreeGC (dpy, gc);
+
+    image->data = NULL;
+    XDestroyImage (image);
+    g_free (data);
+
+    pict = XRenderCreatePicture (dpy, *pixmap, format, 0, NULL);
+
+    return pict;
+}
+#endif
+
 gboolean
-xfwmPixmapLoad (ScreenInfo * screen_info, xfwmPixmap * pm, const gchar * dir, const gchar * file, xfwmColorSymbol * cs)
+xfwmPixmapRenderGdkPixbuf (xfwmPixmap * pm, guint count, GdkPixbuf *pixbuf)
+{
+#ifdef HAVE_RENDER
+    ScreenInfo *screen_info;
+    Display *dpy;
+    Picture src;
+    Pixmap src_pixmap;
+    gint width, height;
+    gint dest_x, dest_y;
+#endif
+    gboolean result;
+    guint i;
+
+    g_return_val_if_fail (pm != NULL, FALSE);
+    g_return_val_if_fail (pixbuf != NULL, FALSE);
+
+    result = TRUE;
+#ifdef HAVE_RENDER
+    screen_info = pm->screen_info;
+    dpy = myScreenGetXDisplay (screen_info);
+    src = None;
+    src_pixmap = None;
+
+    /*
+     * Upload the icon once and blend it server side into each pixmap,
+     * instead of reading each pixmap back to compose it locally.
+     */
+    if (myDisplayHaveRender (screen_info->display_info))
+    {
+        src = xfwmPixmapUploadGdkPixbuf (screen_info, pixbuf, &src_pixmap);
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if ((pm[i].pixmap == None) || (pm[i].mask == None))
+        {
+            continue;
+        }
+        if ((src == None) || (pm[i].pict == None))
+        {
+            result &= xfwmPixmapDrawGdkPixbufOver (&pm[i], pixbuf);
+            continue;
+        }
+
+        width = MIN (gdk_pixbuf_get_width (pixbuf), pm[i].width);
+        height = MIN (gdk_pixbuf_get_height (pixbuf), pm[i].height);
+
+        /* Add 1 for rounding */
+        dest_x = (pm[i].width - width + 1) / 2;
+        dest_y = (pm[i].height - height + 1) / 2;
+
+        XRenderComposite (dpy, PictOpOver, src, None, pm[i].pict,
+                          0, 0, 0, 0, dest_x, dest_y, width, height);
+    }
+
+    if (src != None)
+    {
+        XRenderFreePicture (dpy, src);
+    }
+    if (src_pixmap != None)
+    {
+        XFreePixmap (dpy, src_pixmap);
+    }
+#else
+    for (i = 0; i < count; i++)
+    {
+        if ((pm[i].pixmap != None) && (pm[i].mask != None))
+        {
+            result &= xfwmPixmapDrawGdkPixbufOver (&pm[i], pixbuf);
+        }
+    }
+#endif
+
+    return result;
+}
+
+GdkPixbuf *
+xfwmPixmapLoadGdkPixbuf (const gchar * dir, const gchar * file, xfwmColorSymbol * cs)
 {
     gchar *filename;
     gchar *filexpm;
     GdkPixbuf *pixbuf;
 
-    TRACE ("entering xfwmPixmapLoad");
+    TRACE ("entering xfwmPixmapLoadGdkPixbuf");
 
-    g_return_val_if_fail (pm != NULL, FALSE);
-    g_return_val_if_fail (dir != NULL, FALSE);
-    g_return_val_if_fail (file != NULL, FALSE);
+    g_return_val_if_fail (dir != NULL, NULL);
+    g_return_val_if_fail (file != NULL, NULL);
 
-    xfwmPixmapInit (screen_info, pm);
     /*
      * Always try to load the XPM first, using our own routine
      * that supports XPM color symbol susbstitution (used to
@@ -958,7 +1174,17 @@ xfwmPixmapLoad (ScreenInfo * screen_info, xfwmPixmap * pm, const gchar * dir, co
     g_free (filename);
 
     /* Compose with other image formats, if any available. */
-    pixbuf = xfwmPixmapCompose (pixbuf, dir, file);
+    return xfwmPixmapCompose (pixbuf, dir, file);
+}
+
+gboolean
+xfwmPixmapLoadFromGdkPixbuf (ScreenInfo * screen_info, xfwmPixmap * pm, GdkPixbuf *pixbuf)
+{
+    TRACE ("entering xfwmPixmapLoadFromGdkPixbuf");
+
+    g_return_val_if_fail (pm != NULL, FALSE);
+
+    xfwmPixmapInit (screen_info, pm);
     if (!pixbuf)
     {
         /*
@@ -976,7 +1202,150 @@ xfwmPixmapLoad (ScreenInfo * screen_info, xfwmPixmap * pm, const gchar * dir, co
 #ifdef HAVE_RENDER
     xfwmPixmapRefreshPict (pm);
 #endif
-    g_object_unref (pixbuf);
+
+    return TRUE;
+}
+
+gboolean
+xfwmPixmapLoad (ScreenInfo * screen_info, xfwmPixmap * pm, const gchar * dir, const gchar * file, xfwmColorSymbol * cs)
+{
+    GdkPixbuf *pixbuf;
+    gboolean result;
+
+    TRACE ("entering xfwmPixmapLoad");
+
+    g_return_val_if_fail (pm != NULL, FALSE);
+    g_return_val_if_fail (dir != NULL, FALSE);
+    g_return_val_if_fail (file != NULL, FALSE);
+
+    pixbuf = xfwmPixmapLoadGdkPixbuf (dir, file, cs);
+    result = xfwmPixmapLoadFromGdkPixbuf (screen_info, pm, pixbuf);
+    if (pixbuf)
+    {
+        g_object_unref (pixbuf);
+    }
+
+    return result;
+}
+
+/*
+ * Upload all the given parts at once in a temporary atlas pixmap, then
+ * copy each part out of it on the server side. The parts get a pixmap,
+ * mask and picture of their own, as those are used as window backgrounds,
+ * fill tiles and shape masks, and the atlas is freed afterwards.
+ */
+gboolean
+xfwmPixmapLoadAtlas (ScreenInfo * screen_info, xfwmPixmap ** pms,
+                     GdkPixbuf ** pixbufs, guint count)
+{
+    Display *dpy;
+    xfwmPixmap atlas;
+    GdkPixbuf *atlas_pixbuf;
+    GdkRectangle *rects;
+    GC gc, mask_gc;
+    gint atlas_width, atlas_height;
+    gint x, y, row_height;
+    gint alpha_threshold;
+    guint i;
+
+    TRACE ("entering xfwmPixmapLoadAtlas, count=%i", count);
+
+    g_return_val_if_fail (screen_info != NULL, FALSE);
+
+    /* Simple shelf packing, in the order of the parts */
+    atlas_width = ATLAS_MIN_WIDTH;
+    for (i = 0; i < count; i++)
+    {
+        if (pixbufs[i])
+        {
+            atlas_width = MAX (atlas_width, gdk_pixbuf_get_width (pixbufs[i]));
+        }
+    }
+
+    rects = g_new0 (GdkRectangle, count);
+    x = y = row_height = 0;
+    for (i = 0; i < count; i++)
+    {
+        if (!pixbufs[i])
+        {
+            continue;
+        }
+        rects[i].width = gdk_pixbuf_get_width (pixbufs[i]);
+        rects[i].height = gdk_pixbuf_get_height (pixbufs[i]);
+        if (x + rects[i].width > atlas_width)
+        {
+            x = 0;
+            y += row_height;
+            row_height = 0;
+        }
+        rects[i].x = x;
+        rects[i].y = y;
+        x += rects[i].width;
+        row_height = MAX (row_height, rects[i].height);
+    }
+    atlas_height = y + row_height;
+
+    if ((atlas_height < 1) || (atlas_height > ATLAS_MAX_HEIGHT))
+    {
+        /* Nothing to pack or too large for a single pixmap, load parts one by one */
+        for (i = 0; i < count; i++)
+        {
+            xfwmPixmapLoadFromGdkPixbuf (screen_info, pms[i], pixbufs[i]);
+        }
+        g_free (rects);
+
+        return FALSE;
+    }
+
+    atlas_pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, atlas_width, atlas_height);
+    gdk_pixbuf_fill (atlas_pixbuf, 0x00000000);
+    for (i = 0; i < count; i++)
+    {
+        if (pixbufs[i])
+        {
+            gdk_pixbuf_copy_area (pixbufs[i], 0, 0, rects[i].width, rects[i].height,
+                                  atlas_pixbuf, rects[i].x, rects[i].y);
+        }
+    }
+
+    xfwmPixmapCreate (screen_info, &atlas, atlas_width, atlas_height);
+    /* The shape of each part is computed from its own pixbuf below */
+    gdk_region_destroy (atlas.shape);
+    atlas.shape = NULL;
+    xfwmPixmapDrawFromGdkPixbuf (&atlas, atlas_pixbuf);
+    g_object_unref (atlas_pixbuf);
+
+    dpy = myScreenGetXDisplay (screen_info);
+    gc = XCreateGC (dpy, atlas.pixmap, 0, NULL);
+    mask_gc = XCreateGC (dpy, atlas.mask, 0, NULL);
+
+    for (i = 0; i < count; i++)
+    {
+        if (!pixbufs[i])
+        {
+            xfwmPixmapInit (screen_info, pms[i]);
+            continue;
+        }
+
+        xfwmPixmapCreate (screen_info, pms[i], rects[i].width, rects[i].height);
+        XCopyArea (dpy, atlas.pixmap, pms[i]->pixmap, gc,
+                   rects[i].x, rects[i].y, rects[i].width, rects[i].height, 0, 0);
+        XCopyArea (dpy, atlas.mask, pms[i]->mask, mask_gc,
+                   rects[i].x, rects[i].y, rects[i].width, rects[i].height, 0, 0);
+
+        gdk_region_destroy (pms[i]->shape);
+        alpha_threshold = (gdk_pixbuf_get_has_alpha (pixbufs[i]) ? 0xFF : 0);
+        pms[i]->shape = xfwmPixmapShapeFromGdkPixbuf (pixbufs[i], rects[i].width,
+                                                      rects[i].height, alpha_threshold);
+#ifdef HAVE_RENDER
+        xfwmPixmapRefreshPict (pms[i]);
+#endif
+    }
+
+    XFreeGC (dpy, gc);
+    XFreeGC (dpy, mask_gc);
+    xfwmPixmapFree (&atlas);
+    g_free (rects);
 
     return TRUE;
 }
@@ -1002,6 +1371,7 @@ xfwmPixmapCreate (ScreenInfo * screen_info, xfwmPixmap * pm,
                                   pm->pixmap, width, height, 1);
         pm->width = width;
         pm->height = height;
+        pm->shape = gdk_region_new ();
 #ifdef HAVE_RENDER
         pm->pict_format = XRenderFindVisualFormat (myScreenGetXDisplay (screen_info),
                                                    screen_info->visual);
@@ -1018,6 +1388,7 @@ xfwmPixmapInit (ScreenInfo * screen_info, xfwmPixmap * pm)
     pm->mask = None;
     pm->width = 0;
     pm->height = 0;
+    pm->shape = NULL;
 #ifdef HAVE_RENDER
     pm->pict_format = XRenderFindVisualFormat (myScreenGetXDisplay (screen_info),
                                                screen_info->visual);
@@ -1043,6 +1414,11 @@ xfwmPixmapFree (xfwmPixmap * pm)
         XFreePixmap (myScreenGetXDisplay(pm->screen_info), pm->mask);
         pm->mask = None;
     }
+    if (pm->shape)
+    {
+        gdk_region_destroy (pm->shape);
+        pm->shape = NULL;
+    }
 #ifdef HAVE_RENDER
     if (pm->pict != None)
     {
@@ -1093,6 +1469,72 @@ xfwmPixmapFillRectangle (Display *dpy, int screen, Pixmap pm, Drawable d,
     XFreeGC (dpy, gc);
 }
 
+static void
+xfwmPixmapFillShape (xfwmPixmap * src, xfwmPixmap * dst,
+                     gint x, gint y, gint width, gint height)
+{
+    GdkRegion *tile;
+    GdkRegion *area;
+    GdkRectangle rect;
+    GdkRectangle *rects;
+    gint tx, ty, count;
+
+    if (!dst->shape)
+    {
+        return;
+    }
+    if ((!src->shape) || (src->width < 1) || (src->height < 1))
+    {
+        gdk_region_destroy (dst->shape);
+        dst->shape = NULL;
+        return;
+    }
+
+    rect.x = x;
+    rect.y = y;
+    rect.width = width;
+    rect.height = height;
+    area = gdk_region_rectangle (&rect);
+    gdk_region_subtract (dst->shape, area);
+
+    /* Most theme parts are fully opaque, the whole area is then set */
+    gdk_region_get_rectangles (src->shape, &rects, &count);
+    if ((count == 1) && (rects[0].x == 0) && (rects[0].y == 0) &&
+        (rects[0].width == src->width) && (rects[0].height == src->height))
+    {
+        gdk_region_union (dst->shape, area);
+        gdk_region_destroy (area);
+        g_free (rects);
+        return;
+    }
+    g_free (rects);
+
+    /* Same tile origin as xfwmPixmapFillRectangle(), i.e. (x, 0) */
+    count = ((width + src->width - 1) / src->width) *
+            ((y + height + src->height - 1) / src->height - y / src->height);
+    if (count > 256)
+    {
+        /* Not worth it, let the shape be computed by the server */
+        gdk_region_destroy (dst->shape);
+        dst->shape = NULL;
+        gdk_region_destroy (area);
+        return;
+    }
+
+    for (ty = (y / src->height) * src->height; ty < y + height; ty += src->height)
+    {
+        for (tx = x; tx < x + width; tx += src->width)
+        {
+            tile = gdk_region_copy (src->shape);
+            gdk_region_offset (tile, tx, ty);
+            gdk_region_intersect (tile, area);
+            gdk_region_union (dst->shape, tile);
+            gdk_region_destroy (tile);
+        }
+    }
+    gdk_region_destroy (area);
+}
+
 void
 xfwmPixmapFill (xfwmPixmap * src, xfwmPixmap * dst,
                 gint x, gint y, gint width, gint height)
@@ -1104,6 +1546,8 @@ xfwmPixmapFill (xfwmPixmap * src, xfwmPixmap * dst,
         return;
     }
 
+    xfwmPixmapFillShape (src, dst, x, y, width, height);
+
     xfwmPixmapFillRectangle (myScreenGetXDisplay (src->screen_info),
                              src->screen_info->screen,
                              src->pixmap, dst->pixmap, x, y, width, height);
@@ -52,16 +52,29 @@ struct _xfwmPixmap
     XRenderPictFormat *pict_format;
     Picture pict;
 #endif
+    /* Client side copy of the mask, NULL when not known */
+    GdkRegion *shape;
     gint width, height;
 };
 
 gboolean                 xfwmPixmapRenderGdkPixbuf              (xfwmPixmap *,
+                                                                 guint,
+                                                                 GdkPixbuf *);
+GdkPixbuf               *xfwmPixmapLoadGdkPixbuf                (const gchar *,
+                                                                 const gchar *,
+                                                                 xfwmColorSymbol *);
+gboolean                 xfwmPixmapLoadFromGdkPixbuf            (ScreenInfo *,
+                                                                 xfwmPixmap *,
                                                                  GdkPixbuf *);
 gboolean                 xfwmPixmapLoad                         (ScreenInfo *,
                                                                  xfwmPixmap *,
                                                                  const gchar *,
                                                                  const gchar *,
                                                                  xfwmColorSymbol *);
+gboolean                 xfwmPixmapLoadAtlas                    (ScreenInfo *,
+                                                                 xfwmPixmap **,
+                                                                 GdkPixbuf **,
+                                                                 guint);
 void                     xfwmPixmapCreate                       (ScreenInfo *,
                                                                  xfwmPixmap *,
                                                                  gint,
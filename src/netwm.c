@@ -936,36 +936,124 @@ clientGetInitialNetWmDesktop (Client * c)
     }
 }
 
-void
-clientSetNetClientList (ScreenInfo * screen_info, Atom a, GList * list)
+static void
+clientPublishNetClientList (ScreenInfo * screen_info, Atom a, GList * list, NetClientList * published)
 {
-    Window *listw;
-    Window *index_dest;
     GList *index_src;
-    gint size, i;
+    gboolean changed;
+    guint size, i;
 
-    TRACE ("entering clientSetNetClientList");
+    TRACE ("entering clientPublishNetClientList");
 
+    published->pending = FALSE;
     size = g_list_length (list);
+    /* The very first update is always written, to clear any stale list left by a previous WM */
+    changed = ((published->windows == NULL) || (size != published->count));
+
+    if (size >= published->allocated)
+    {
+        published->allocated = size + 16;
+        published->windows = g_renew (Window, published->windows, published->allocated);
+    }
+
+    /* Compare against the last published content while refreshing it in place */
+    for (i = 0, index_src = list; i < size; i++, index_src = g_list_next (index_src))
+    {
+        Client *c = (Client *) index_src->data;
+        if (published->windows[i] != c->window)
+        {
+            published->windows[i] = c->window;
+            changed = TRUE;
+        }
+    }
+    published->count = size;
+
+    if (!changed)
+    {
+        TRACE ("client list unchanged, not republished");
+        return;
+    }
+
+    screen_info->client_list_updates++;
     if (size < 1)
     {
         XDeleteProperty (myScreenGetXDisplay (screen_info), screen_info->xroot, a);
         return;
     }
 
-    listw = g_new (Window, size + 1);
-    if (listw)
+    TRACE ("%i windows in list for %i clients", size, screen_info->client_count);
+    XChangeProperty (myScreenGetXDisplay (screen_info), screen_info->xroot, a, XA_WINDOW, 32, PropModeReplace,
+                     (unsigned char *) published->windows, size);
+}
+
+void
+clientFlushNetClientList (ScreenInfo * screen_info)
+{
+    DisplayInfo *display_info;
+
+    g_return_if_fail (screen_info != NULL);
+    TRACE ("entering clientFlushNetClientList");
+
+    if (screen_info->client_list_idle_id)
+    {
+        g_source_remove (screen_info->client_list_idle_id);
+        screen_info->client_list_idle_id = 0;
+    }
+
+    display_info = screen_info->display_info;
+    if (screen_info->net_client_list.pending)
     {
-        TRACE ("%i windows in list for %i clients", size, screen_info->client_count);
-        for (i = 0, index_dest = listw, index_src = list; i < size;
-            i++, index_dest++, index_src = g_list_next (index_src))
-        {
-            Client *c = (Client *) index_src->data;
-            *index_dest = c->window;
-        }
-        XChangeProperty (myScreenGetXDisplay (screen_info), screen_info->xroot, a, XA_WINDOW, 32, PropModeReplace,
-            (unsigned char *) listw, size);
-        g_free (listw);
+        clientPublishNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST],
+                                    screen_info->windows, &screen_info->net_client_list);
+    }
+    if (screen_info->net_client_list_stacking.pending)
+    {
+        clientPublishNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING],
+                                    screen_info->windows_stack, &screen_info->net_client_list_stacking);
+    }
+}
+
+static gboolean
+client_list_idle_cb (gpointer data)
+{
+    ScreenInfo *screen_info;
+
+    TRACE ("entering client_list_idle_cb");
+
+    screen_info = (ScreenInfo *) data;
+    screen_info->client_list_idle_id = 0;
+    clientFlushNetClientList (screen_info);
+
+    return (FALSE);
+}
+
+void
+clientSetNetClientList (ScreenInfo * screen_info, Atom a)
+{
+    DisplayInfo *display_info;
+
+    g_return_if_fail (screen_info != NULL);
+    TRACE ("entering clientSetNetClientList");
+
+    display_info = screen_info->display_info;
+    if (a == display_info->atoms[NET_CLIENT_LIST])
+    {
+        screen_info->net_client_list.pending = TRUE;
+    }
+    else if (a == display_info->atoms[NET_CLIENT_LIST_STACKING])
+    {
+        screen_info->net_client_list_stacking.pending = TRUE;
+    }
+    else
+    {
+        return;
+    }
+
+    /* Publish once all the changes from the current batch of events are applied */
+    if (screen_info->client_list_idle_id == 0)
+    {
+        screen_info->client_list_idle_id =
+            g_idle_add_full (G_PRIORITY_DEFAULT_IDLE, client_list_idle_cb, screen_info, NULL);
     }
 }
 
@@ -1312,6 +1400,8 @@ clientWindowType (Client * c)
         c->type = UNSET;
         c->initial_layer = c->win_layer;
     }
+    /* Dialogs and utilities may have been made transient for their group */
+    clientTransientsUpdate (c);
 
     if (clientIsValidTransientOrModal (c))
     {
@@ -1566,6 +1656,10 @@ clientAddUserTimeWin (Client * c)
     {
         XSelectInput (display_info->dpy, c->user_time_win, PropertyChangeMask);
     }
+    if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_MANAGED))
+    {
+        myDisplayAddClientWindow (display_info, c->user_time_win, c, SEARCH_WIN_USER_TIME);
+    }
 }
 
 void
@@ -1583,5 +1677,7 @@ clientRemoveUserTimeWin (Client * c)
     if ((c->user_time_win != None) && (c->user_time_win != c->window))
     {
         XSelectInput (display_info->dpy, c->user_time_win, NoEventMask);
+        discardPrefetchedProperties (display_info, c->user_time_win);
     }
+    myDisplayRemoveClientWindow (display_info, c->user_time_win, c, SEARCH_WIN_USER_TIME);
 }
@@ -47,8 +47,8 @@ void                     clientUpdateFullscreenState            (Client *);
 void                     clientGetNetWmType                     (Client *);
 void                     clientGetInitialNetWmDesktop           (Client *);
 void                     clientSetNetClientList                 (ScreenInfo *,
-                                                                 Atom,
-                                                                 GList *);
+                                                                 Atom);
+void                     clientFlushNetClientList               (ScreenInfo *);
 gboolean                 clientValidateNetStrut                 (Client *);
 gboolean                 clientGetNetStruts                     (Client *);
 void                     clientSetNetActions                    (Client *);
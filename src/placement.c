@@ -26,6 +26,7 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <stdlib.h>
 #include <glib.h>
 #include <libxfce4util/libxfce4util.h>
 
@@ -39,6 +40,15 @@
 #include "netwm.h"
 
 
+typedef struct _PlacementRect PlacementRect;
+struct _PlacementRect
+{
+    gint x0;
+    gint y0;
+    gint x1;
+    gint y1;
+};
+
 /* Compute rectangle overlap area */
 
 static inline unsigned long
@@ -532,17 +542,59 @@ clientAutoMaximize (Client * c, int full_w, int full_h)
     }
 }
 
+/*
+ * Along a row of candidate positions, the overlap of the new window
+ * with one rectangle is a piecewise linear function of the window left
+ * edge u: it grows with slope 1 from u = x0 - width, stops growing at
+ * x0 or x1 - width, and falls back to 0 at x1. It can be written as
+ *   R(u - (x0 - width)) - R(u - x0) - R(u - (x1 - width)) + R(u - x1)
+ * with R(t) = max (t, 0). Each term is an edge, sorted once by position,
+ * and weighted on each row by the height shared with the rectangle.
+ */
+typedef struct _PlacementEdge PlacementEdge;
+struct _PlacementEdge
+{
+    gint pos;
+    gint sign;
+    guint rect;
+};
+
+static gint
+placementEdgeCompare (gconstpointer a, gconstpointer b)
+{
+    const PlacementEdge *e1 = (const PlacementEdge *) a;
+    const PlacementEdge *e2 = (const PlacementEdge *) b;
+
+    if (e1->pos < e2->pos)
+    {
+        return -1;
+    }
+    return (e1->pos > e2->pos);
+}
+
+static void
+placementAddEdge (PlacementEdge *edges, guint *n_edges, gint pos, gint sign, guint rect)
+{
+    edges[*n_edges].pos = pos;
+    edges[*n_edges].sign = sign;
+    edges[*n_edges].rect = rect;
+    (*n_edges)++;
+}
+
 static void
 smartPlacement (Client * c, int full_x, int full_y, int full_w, int full_h)
 {
     Client *c2;
     ScreenInfo *screen_info;
-    gfloat best_overlaps;
-    guint i;
-    gint test_x, test_y, xmax, ymax, best_x, best_y;
+    PlacementRect *rects;
+    PlacementEdge *edges;
+    gint64 *row_overlaps;
+    gint64 best_overlaps, count_overlaps;
+    gint64 slope, offset, weight;
+    guint i, e, n_rects, n_edges;
+    gint test_x, test_y, xmax, ymax, best_x, best_y, left;
     gint frame_height, frame_width, frame_left, frame_top;
-    gboolean first;
-    gint c2_x, c2_y;
+    gboolean first, found;
 
     g_return_if_fail (c != NULL);
     TRACE ("entering smartPlacement");
@@ -554,48 +606,79 @@ smartPlacement (Client * c, int full_x, int full_y, int full_w, int full_h)
     frame_top = frameTop (c);
     test_x = 0;
     test_y = 0;
-    best_overlaps = 0.0;
+    best_overlaps = 0;
     first = TRUE;
+    found = FALSE;
 
     xmax = full_x + full_w - c->width - frameRight (c);
     ymax = full_y + full_h - c->height - frameBottom (c);
     best_x = full_x + frameLeft (c);
     best_y = full_y + frameTop (c);
 
+    /* Collect the frames of the windows to avoid and their edges once for all */
+    TRACE ("analyzing %i clients", screen_info->client_count);
+    rects = g_new (PlacementRect, screen_info->client_count + 1);
+    edges = g_new (PlacementEdge, 4 * (screen_info->client_count + 1));
+    row_overlaps = g_new (gint64, screen_info->client_count + 1);
+    n_rects = 0;
+    n_edges = 0;
+    for (c2 = screen_info->clients, i = 0; i < screen_info->client_count; c2 = c2->next, i++)
+    {
+        if ((c2 != c) && (c2->type != WINDOW_DESKTOP)
+            && (c->win_workspace == c2->win_workspace)
+            && FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE))
+        {
+            rects[n_rects].x0 = frameX (c2);
+            rects[n_rects].y0 = frameY (c2);
+            rects[n_rects].x1 = rects[n_rects].x0 + frameWidth (c2);
+            rects[n_rects].y1 = rects[n_rects].y0 + frameHeight (c2);
+            placementAddEdge (edges, &n_edges, rects[n_rects].x0 - frame_width, 1, n_rects);
+            placementAddEdge (edges, &n_edges, rects[n_rects].x0, -1, n_rects);
+            placementAddEdge (edges, &n_edges, rects[n_rects].x1 - frame_width, -1, n_rects);
+            placementAddEdge (edges, &n_edges, rects[n_rects].x1, 1, n_rects);
+            n_rects++;
+        }
+    }
+    qsort (edges, n_edges, sizeof (PlacementEdge), placementEdgeCompare);
+
     test_y = full_y + frameTop (c);
     do
     {
+        /* The vertical overlap with each window is the same for the whole row */
+        for (i = 0; i < n_rects; i++)
+        {
+            row_overlaps[i] = segment_overlap (test_y - frame_top,
+                                               test_y - frame_top + frame_height,
+                                               rects[i].y0,
+                                               rects[i].y1);
+        }
+
+        /*
+         * Sweep the row from left to right, the overlap at u is
+         * the sum of weight * (u - pos) over the edges passed so far.
+         */
+        slope = 0;
+        offset = 0;
+        e = 0;
         test_x = full_x + frameLeft (c);
         do
         {
-            gfloat count_overlaps = 0.0;
-            TRACE ("analyzing %i clients", screen_info->client_count);
-            for (c2 = screen_info->clients, i = 0; i < screen_info->client_count; c2 = c2->next, i++)
+            left = test_x - frame_left;
+            for (; (e < n_edges) && (edges[e].pos <= left); e++)
             {
-                if ((c2 != c) && (c2->type != WINDOW_DESKTOP)
-                    && (c->win_workspace == c2->win_workspace)
-                    && FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE))
-                {
-                    c2_x = frameX (c2);
-                    c2_y = frameY (c2);
-
-                    count_overlaps += overlap (test_x - frame_left,
-                                               test_y - frame_top,
-                                               test_x - frame_left + frame_width,
-                                               test_y - frame_top + frame_height,
-                                               c2_x,
-                                               c2_y,
-                                               c2_x + frameWidth (c2),
-                                               c2_y + frameHeight (c2));
-                }
+                weight = edges[e].sign * row_overlaps[edges[e].rect];
+                slope += weight;
+                offset += weight * edges[e].pos;
             }
-            if (count_overlaps < 0.1)
+            count_overlaps = slope * left - offset;
+
+            if (count_overlaps == 0)
             {
                 TRACE ("overlaps is 0 so it's the best we can get");
-                c->x = test_x;
-                c->y = test_y;
-
-                return;
+                best_x = test_x;
+                best_y = test_y;
+                found = TRUE;
+                break;
             }
             else if ((count_overlaps < best_overlaps) || (first))
             {
@@ -612,7 +695,11 @@ smartPlacement (Client * c, int full_x, int full_y, int full_w, int full_h)
         while (test_x <= xmax);
         test_y += 8;
     }
-    while (test_y <= ymax);
+    while ((!found) && (test_y <= ymax));
+
+    g_free (row_overlaps);
+    g_free (edges);
+    g_free (rects);
 
     c->x = best_x;
     c->y = best_y;
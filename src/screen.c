@@ -47,7 +47,9 @@
 #include "screen.h"
 #include "misc.h"
 #include "mywindow.h"
+#include "netwm.h"
 #include "compositor.h"
+#include "stats.h"
 #include "ui_style.h"
 
 #ifndef WM_EXITING_TIMEOUT
@@ -92,6 +94,7 @@ myScreenSetWMAtom (ScreenInfo *screen_info, gboolean replace_wm)
     display_name = gdk_screen_make_display_name (screen_info->gscr);
     wm_name = gdk_x11_screen_get_window_manager_name (screen_info->gscr);
 
+    statsCount (STATS_XSYNC);
     XSync (display_info->dpy, FALSE);
     current_wm = XGetSelectionOwner (display_info->dpy, wm_sn_atom);
     if (current_wm)
@@ -240,8 +243,33 @@ myScreenInit (DisplayInfo *display_info, GdkScreen *gscr, unsigned long event_ma
     screen_info->workspace_names_items = 0;
 
     screen_info->windows_stack = NULL;
+    for (i = 0; i < WIN_LAYER_COUNT; i++)
+    {
+        screen_info->layer_head[i] = NULL;
+        screen_info->layer_tail[i] = NULL;
+    }
+    screen_info->stack_top = NULL;
     screen_info->last_raise = NULL;
+    screen_info->applied_stack = NULL;
+    screen_info->applied_count = 0;
+    screen_info->restack_requests = 0;
     screen_info->windows = NULL;
+    screen_info->net_client_list.windows = NULL;
+    screen_info->net_client_list.count = 0;
+    screen_info->net_client_list.allocated = 0;
+    screen_info->net_client_list.pending = FALSE;
+    screen_info->net_client_list_stacking.windows = NULL;
+    screen_info->net_client_list_stacking.count = 0;
+    screen_info->net_client_list_stacking.allocated = 0;
+    screen_info->net_client_list_stacking.pending = FALSE;
+    screen_info->client_list_idle_id = 0;
+    screen_info->client_list_updates = 0;
+    screen_info->frame_queue = NULL;
+    screen_info->frame_idle_id = 0;
+    screen_info->transients_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+    screen_info->groups_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+    screen_info->workspace_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+    screen_info->visible_index = g_hash_table_new (g_direct_hash, g_direct_equal);
     screen_info->clients = NULL;
     screen_info->client_count = 0;
     screen_info->client_serial = 0L;
@@ -357,6 +385,22 @@ myScreenClose (ScreenInfo *screen_info)
     display_info = screen_info->display_info;
 
     clientUnframeAll (screen_info);
+    clientFlushNetClientList (screen_info);
+    if (screen_info->frame_idle_id)
+    {
+        g_source_remove (screen_info->frame_idle_id);
+        screen_info->frame_idle_id = 0;
+    }
+    g_slist_free (screen_info->frame_queue);
+    screen_info->frame_queue = NULL;
+    multimapDestroy (screen_info->transients_index);
+    screen_info->transients_index = NULL;
+    multimapDestroy (screen_info->groups_index);
+    screen_info->groups_index = NULL;
+    multimapDestroy (screen_info->workspace_index);
+    screen_info->workspace_index = NULL;
+    g_hash_table_destroy (screen_info->visible_index);
+    screen_info->visible_index = NULL;
     compositorUnmanageScreen (screen_info);
     closeSettings (screen_info);
 
@@ -387,10 +431,26 @@ myScreenClose (ScreenInfo *screen_info)
 
     g_list_free (screen_info->windows_stack);
     screen_info->windows_stack = NULL;
+    screen_info->stack_top = NULL;
+
+    DBG ("%u restack request(s) issued", screen_info->restack_requests);
+    g_free (screen_info->applied_stack);
+    screen_info->applied_stack = NULL;
+    screen_info->applied_count = 0;
 
     g_list_free (screen_info->windows);
     screen_info->windows = NULL;
 
+    DBG ("%u client list update(s) published", screen_info->client_list_updates);
+    g_free (screen_info->net_client_list.windows);
+    screen_info->net_client_list.windows = NULL;
+    screen_info->net_client_list.count = 0;
+    screen_info->net_client_list.allocated = 0;
+    g_free (screen_info->net_client_list_stacking.windows);
+    screen_info->net_client_list_stacking.windows = NULL;
+    screen_info->net_client_list_stacking.count = 0;
+    screen_info->net_client_list_stacking.allocated = 0;
+
     if (screen_info->monitors_index)
     {
         g_array_free (screen_info->monitors_index, TRUE);
@@ -594,6 +654,7 @@ myScreenGetModifierPressed (ScreenInfo *screen_info)
     unsigned int modifiers;
     int rx, ry, wx, wy;
 
+    statsCount (STATS_QUERY_POINTER);
     XQueryPointer (myScreenGetXDisplay (screen_info), screen_info->xroot,
                    &dr, &window, &rx, &ry, &wx, &wy, &modifiers);
 
@@ -604,18 +665,15 @@ Client *
 myScreenGetClientFromWindow (ScreenInfo *screen_info, Window w, unsigned short mode)
 {
     Client *c;
-    guint i;
 
     g_return_val_if_fail (w != None, NULL);
     TRACE ("entering myScreenGetClientFromWindow");
     TRACE ("looking for (0x%lx)", w);
 
-    for (c = screen_info->clients, i = 0; i < screen_info->client_count; c = c->next, i++)
+    c = myDisplayGetClientFromWindow (screen_info->display_info, w, mode);
+    if ((c) && (c->screen_info == screen_info))
     {
-        if (clientGetFromWindow (c, w, mode))
-        {
-            return (c);
-        }
+        return (c);
     }
     TRACE ("no client found");
 
@@ -63,6 +63,14 @@ struct _gaussian_conv {
 typedef struct _gaussian_conv gaussian_conv;
 #endif /* HAVE_COMPOSITOR */
 
+struct _NetClientList {
+    Window *windows;
+    guint count;
+    guint allocated;
+    gboolean pending;
+};
+typedef struct _NetClientList NetClientList;
+
 struct _ScreenInfo
 {
     /* The display this screen belongs to */
@@ -70,8 +78,27 @@ struct _ScreenInfo
 
     /* Window stacking, per screen */
     GList *windows_stack;
+    /* Per layer view of windows_stack, see stacking.c */
+    Client *layer_head[WIN_LAYER_COUNT];
+    Client *layer_tail[WIN_LAYER_COUNT];
+    GList *stack_top;
     Client *last_raise;
+    Window *applied_stack;
+    guint applied_count;
+    guint restack_requests;
     GList *windows;
+    NetClientList net_client_list;
+    NetClientList net_client_list_stacking;
+    guint client_list_idle_id;
+    guint client_list_updates;
+    GSList *frame_queue;
+    guint frame_idle_id;
+    /* Managed clients by transient_for and by group_leader, Window -> GSList */
+    GHashTable *transients_index;
+    GHashTable *groups_index;
+    /* Managed clients by workspace (ALL_WORKSPACES if sticky), and visible ones */
+    GHashTable *workspace_index;
+    GHashTable *visible_index;
     Client *clients;
     guint client_count;
     unsigned long client_serial;
@@ -167,6 +194,8 @@ struct _ScreenInfo
     gint gaussianSize;
     guchar *shadowCorner;
     guchar *shadowTop;
+    GList *shadow_cache;
+    GList *shadow_tiles;
 
     Picture rootPicture;
     Picture rootBuffer;
@@ -175,12 +204,29 @@ struct _ScreenInfo
     XserverRegion allDamage;
 
     guint wins_unredirected;
+    Window unredirect_win;
+    Window unredirect_candidate;
+    guint unredirect_timeout_id;
+    gint64 unredirect_start;
+    gint64 unredirect_time;
+    guint unredirect_count;
+
     gboolean compositor_active;
     gboolean clipChanged;
+    gboolean occlusion_valid;
+
+    guint wins_painted;
+    guint wins_occluded;
+    guint regions_created;
 
     gboolean damages_pending;
 
     guint compositor_timeout_id;
+    gint refresh_rate;
+    gint64 last_repaint;
+    gint64 next_repaint;
+    guint frames_painted;
+    guint frames_missed;
 #endif /* HAVE_COMPOSITOR */
 };
 
@@ -43,6 +43,7 @@
 #include "workspaces.h"
 #include "compositor.h"
 #include "ui_style.h"
+#include "themecache.h"
 
 #define CHANNEL_XFWM            "xfwm4"
 #define THEMERC                 "themerc"
@@ -302,6 +303,21 @@ getTitleShadow (Settings *rc, const gchar * name)
     return TITLE_SHADOW_NONE;
 }
 
+static void
+loadThemePart (GPtrArray *pms, GPtrArray *pixbufs, ThemeCache *cache, xfwmPixmap *pm,
+               const gchar *theme, const gchar *imagename, xfwmColorSymbol *colsym)
+{
+    GdkPixbuf *pixbuf;
+
+    if (!themeCacheLookup (cache, imagename, &pixbuf))
+    {
+        pixbuf = xfwmPixmapLoadGdkPixbuf (theme, imagename, colsym);
+        themeCacheStore (cache, imagename, pixbuf);
+    }
+    g_ptr_array_add (pms, pm);
+    g_ptr_array_add (pixbufs, pixbuf);
+}
+
 static void
 loadTheme (ScreenInfo *screen_info, Settings *rc)
 {
@@ -396,6 +412,8 @@ loadTheme (ScreenInfo *screen_info, Settings *rc)
     GValue tmp_val2 = { 0, };
     DisplayInfo *display_info;
     xfwmColorSymbol colsym[ XPM_COLOR_SYMBOL_SIZE + 1 ];
+    ThemeCache *cache;
+    GPtrArray *pms, *pixbufs;
     GtkWidget *widget;
     gchar *theme;
     const gchar *font;
@@ -488,44 +506,59 @@ loadTheme (ScreenInfo *screen_info, Settings *rc)
     screen_info->white_gc = widget->style->white_gc;
     g_object_ref (G_OBJECT (widget->style->white_gc));
 
+    cache = themeCacheOpen (theme, colsym);
+    pms = g_ptr_array_new ();
+    pixbufs = g_ptr_array_new ();
+
     for (i = 0; i < SIDE_TOP; i++) /* Keep SIDE_TOP for later */
     {
         g_snprintf(imagename, sizeof (imagename), "%s-active", side_names[i]);
-        xfwmPixmapLoad (screen_info, &screen_info->sides[i][ACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->sides[i][ACTIVE], theme, imagename, colsym);
 
         g_snprintf(imagename, sizeof (imagename), "%s-inactive", side_names[i]);
-        xfwmPixmapLoad (screen_info, &screen_info->sides[i][INACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->sides[i][INACTIVE], theme, imagename, colsym);
     }
     for (i = 0; i < CORNER_COUNT; i++)
     {
         g_snprintf(imagename, sizeof (imagename), "%s-active", corner_names[i]);
-        xfwmPixmapLoad (screen_info, &screen_info->corners[i][ACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->corners[i][ACTIVE], theme, imagename, colsym);
 
         g_snprintf(imagename, sizeof (imagename), "%s-inactive", corner_names[i]);
-        xfwmPixmapLoad (screen_info, &screen_info->corners[i][INACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->corners[i][INACTIVE], theme, imagename, colsym);
     }
     for (i = 0; i < BUTTON_COUNT; i++)
     {
         for (j = 0; j < STATE_COUNT; j++)
         {
             g_snprintf(imagename, sizeof (imagename), "%s-%s", button_names[i], button_state_names[j]);
-            xfwmPixmapLoad (screen_info, &screen_info->buttons[i][j], theme, imagename, colsym);
+            loadThemePart (pms, pixbufs, cache, &screen_info->buttons[i][j], theme, imagename, colsym);
         }
     }
     for (i = 0; i < TITLE_COUNT; i++)
     {
         g_snprintf(imagename, sizeof (imagename), "title-%d-active", i + 1);
-        xfwmPixmapLoad (screen_info, &screen_info->title[i][ACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->title[i][ACTIVE], theme, imagename, colsym);
 
         g_snprintf(imagename, sizeof (imagename), "title-%d-inactive", i + 1);
-        xfwmPixmapLoad (screen_info, &screen_info->title[i][INACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->title[i][INACTIVE], theme, imagename, colsym);
 
         g_snprintf(imagename, sizeof (imagename), "top-%d-active", i + 1);
-        xfwmPixmapLoad (screen_info, &screen_info->top[i][ACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->top[i][ACTIVE], theme, imagename, colsym);
 
         g_snprintf(imagename, sizeof (imagename), "top-%d-inactive", i + 1);
-        xfwmPixmapLoad (screen_info, &screen_info->top[i][INACTIVE], theme, imagename, colsym);
+        loadThemePart (pms, pixbufs, cache, &screen_info->top[i][INACTIVE], theme, imagename, colsym);
     }
+    xfwmPixmapLoadAtlas (screen_info, (xfwmPixmap **) pms->pdata, (GdkPixbuf **) pixbufs->pdata, pms->len);
+    for (i = 0; i < pixbufs->len; i++)
+    {
+        if (g_ptr_array_index (pixbufs, i))
+        {
+            g_object_unref (g_ptr_array_index (pixbufs, i));
+        }
+    }
+    g_ptr_array_free (pixbufs, TRUE);
+    g_ptr_array_free (pms, TRUE);
+    themeCacheClose (cache);
 
     screen_info->box_gc = createGC (screen_info, "#FFFFFF", GXxor, NULL, 2, TRUE);
 
@@ -692,6 +725,7 @@ loadSettings (ScreenInfo *screen_info)
         {"margin_left", NULL, G_TYPE_INT, FALSE},
         {"margin_right", NULL, G_TYPE_INT, FALSE},
         {"margin_top", NULL, G_TYPE_INT, FALSE},
+        {"max_fps", NULL, G_TYPE_INT, TRUE},
         {"maximized_offset", NULL, G_TYPE_INT, TRUE},
         {"move_opacity", NULL, G_TYPE_INT, TRUE},
         {"placement_ratio", NULL, G_TYPE_INT, TRUE},
@@ -797,6 +831,8 @@ loadSettings (ScreenInfo *screen_info)
         CLAMP (getIntValue ("frame_opacity", rc), 0, 100);
     screen_info->params->inactive_opacity =
         CLAMP (getIntValue ("inactive_opacity", rc), 0, 100);
+    screen_info->params->max_fps =
+        CLAMP (getIntValue ("max_fps", rc), 0, 1000);
     screen_info->params->move_opacity =
         CLAMP (getIntValue ("move_opacity", rc), 0, 100);
     screen_info->params->resize_opacity =
@@ -1183,6 +1219,10 @@ cb_xfwm4_channel_property_changed(XfconfChannel *channel, const gchar *property_
                 {
                     screen_info->params->placement_ratio = CLAMP (g_value_get_int(value), 0, 100);
                 }
+                else if (!strcmp (name, "max_fps"))
+                {
+                    screen_info->params->max_fps = CLAMP (g_value_get_int(value), 0, 1000);
+                }
                 else if ((!strcmp (name, "button_offset"))
                       || (!strcmp (name, "button_spacing"))
                       || (!strcmp (name, "double_click_time"))
@@ -179,6 +179,7 @@ struct _XfwmParams
     int focus_delay;
     int frame_opacity;
     int inactive_opacity;
+    int max_fps;
     int maximized_offset;
     int move_opacity;
     int placement_mode;
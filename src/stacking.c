@@ -39,17 +39,105 @@
 #include "transients.h"
 #include "frame.h"
 #include "focus.h"
+#include "workspaces.h"
 
 static guint raise_timeout = 0;
 
+/*
+ * Mark the windows to keep in place when going from the stack applied
+ * last to the new one: the longest sequence of windows already in the
+ * right order, starting with the top most window which XRestackWindows()
+ * would not move either. Returns FALSE if the top most window is new.
+ */
+static gboolean
+clientGetStackToKeep (ScreenInfo *screen_info, Window *xwinstack, guint nwindows, gboolean *keep)
+{
+    GHashTable *old_index;
+    gint *pos, *tails, *prev;
+    gint len, low, high, mid, i;
+    guint j;
+
+    old_index = g_hash_table_new (g_direct_hash, g_direct_equal);
+    for (j = 0; j < screen_info->applied_count; j++)
+    {
+        if (screen_info->applied_stack[j] != None)
+        {
+            g_hash_table_insert (old_index, (gpointer) screen_info->applied_stack[j], GINT_TO_POINTER (j + 1));
+        }
+    }
+
+    pos = g_new (gint, nwindows);
+    for (j = 0; j < nwindows; j++)
+    {
+        pos[j] = GPOINTER_TO_INT (g_hash_table_lookup (old_index, (gconstpointer) xwinstack[j])) - 1;
+        keep[j] = FALSE;
+    }
+    g_hash_table_destroy (old_index);
+
+    if (pos[0] < 0)
+    {
+        g_free (pos);
+        return FALSE;
+    }
+
+    /* Longest increasing subsequence of the previous positions */
+    tails = g_new (gint, nwindows);
+    prev = g_new (gint, nwindows);
+    tails[0] = 0;
+    prev[0] = -1;
+    len = 1;
+    for (i = 1; i < (gint) nwindows; i++)
+    {
+        prev[i] = -1;
+        if (pos[i] <= pos[0])
+        {
+            continue;
+        }
+        low = 1;
+        high = len;
+        while (low < high)
+        {
+            mid = (low + high) / 2;
+            if (pos[tails[mid]] < pos[i])
+            {
+                low = mid + 1;
+            }
+            else
+            {
+                high = mid;
+            }
+        }
+        prev[i] = tails[low - 1];
+        tails[low] = i;
+        if (low == len)
+        {
+            len++;
+        }
+    }
+    for (i = tails[len - 1]; i >= 0; i = prev[i])
+    {
+        keep[i] = TRUE;
+    }
+
+    g_free (tails);
+    g_free (prev);
+    g_free (pos);
+
+    return TRUE;
+}
+
 void
 clientApplyStackList (ScreenInfo *screen_info)
 {
+    Display *dpy;
     Window *xwinstack;
-    guint nwindows;
+    gboolean *keep;
+    XWindowChanges wc;
+    guint nwindows, nrequests;
     gint i;
 
     DBG ("applying stack list");
+    dpy = myScreenGetXDisplay (screen_info);
     nwindows = g_list_length (screen_info->windows_stack);
 
     i = 0;
@@ -71,10 +159,41 @@ clientApplyStackList (ScreenInfo *screen_info)
             DBG ("  [%i] \"%s\" (0x%lx)", i, c->name, c->window);
         }
     }
+    nwindows += 4;
+
+    /*
+     * Only restack the windows which moved since the stack was last
+     * applied, each one just below the window that precedes it in
+     * the new stack, so that the others do not get reconfigured.
+     */
+    keep = g_new (gboolean, nwindows);
+    if ((screen_info->applied_stack) && clientGetStackToKeep (screen_info, xwinstack, nwindows, keep))
+    {
+        nrequests = 0;
+        wc.stack_mode = Below;
+        for (i = 1; i < (gint) nwindows; i++)
+        {
+            if (!keep[i])
+            {
+                wc.sibling = xwinstack[i - 1];
+                XConfigureWindow (dpy, xwinstack[i], CWSibling | CWStackMode, &wc);
+                nrequests++;
+            }
+        }
+    }
+    else
+    {
+        XRestackWindows (dpy, xwinstack, (int) nwindows);
+        nrequests = nwindows - 1;
+    }
+    g_free (keep);
 
-    XRestackWindows (myScreenGetXDisplay (screen_info), xwinstack, (int) nwindows + 4);
+    screen_info->restack_requests += nrequests;
+    DBG ("%u restack request(s) issued, %u in total", nrequests, screen_info->restack_requests);
 
-    g_free (xwinstack);
+    g_free (screen_info->applied_stack);
+    screen_info->applied_stack = xwinstack;
+    screen_info->applied_count = nwindows;
 }
 
 Client *
@@ -158,91 +277,303 @@ clientGetTopMostForGroup (Client * c)
     return top_most;
 }
 
-gboolean
-clientIsTopMost (Client *c)
+/*
+ * windows_stack is kept as a single list, but each layer is also
+ * chained through the clients themselves (layer_head, layer_next,
+ * layer_prev) in stack order, so that the first or last window of a
+ * layer can be found without walking the whole stack. Both are edited
+ * together, in place, by clientStackInsert() and clientStackRemove().
+ *
+ * stack_position orders the clients of different layers. Positions are
+ * spaced by STACK_POSITION_GAP so that a client can be inserted between
+ * two others without renumbering the stack, which only happens when a
+ * gap has been used up.
+ */
+#define STACK_POSITION_GAP (1 << 12)
+
+static void
+clientStackRenumber (ScreenInfo *screen_info)
+{
+    GList *list;
+    guint position;
+
+    TRACE ("entering clientStackRenumber");
+
+    position = 0;
+    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+    {
+        position += STACK_POSITION_GAP;
+        ((Client *) list->data)->stack_position = position;
+    }
+}
+
+static void
+clientStackSetPosition (ScreenInfo *screen_info, Client *c)
+{
+    guint low, high;
+
+    low = (c->stack_link->prev ? ((Client *) c->stack_link->prev->data)->stack_position : 0);
+    if (c->stack_link->next)
+    {
+        high = ((Client *) c->stack_link->next->data)->stack_position;
+    }
+    else if (low <= G_MAXUINT - 2 * STACK_POSITION_GAP)
+    {
+        high = low + 2 * STACK_POSITION_GAP;
+    }
+    else
+    {
+        high = low;
+    }
+
+    if (high - low < 2)
+    {
+        clientStackRenumber (screen_info);
+    }
+    else
+    {
+        c->stack_position = low + (high - low) / 2;
+    }
+}
+
+static void
+clientStackLinkLayer (ScreenInfo *screen_info, Client *c)
+{
+    Client *prev;
+    guint layer;
+
+    layer = MIN (c->win_layer, WIN_LAYER_COUNT - 1);
+    c->stack_layer = layer;
+
+    /* Raised windows land at the top of their layer, so look from there */
+    for (prev = screen_info->layer_tail[layer]; prev; prev = prev->layer_prev)
+    {
+        if (prev->stack_position < c->stack_position)
+        {
+            break;
+        }
+    }
+
+    c->layer_prev = prev;
+    c->layer_next = (prev ? prev->layer_next : screen_info->layer_head[layer]);
+    if (c->layer_next)
+    {
+        c->layer_next->layer_prev = c;
+    }
+    else
+    {
+        screen_info->layer_tail[layer] = c;
+    }
+    if (prev)
+    {
+        prev->layer_next = c;
+    }
+    else
+    {
+        screen_info->layer_head[layer] = c;
+    }
+}
+
+static void
+clientStackUnlinkLayer (ScreenInfo *screen_info, Client *c)
+{
+    if (c->layer_prev)
+    {
+        c->layer_prev->layer_next = c->layer_next;
+    }
+    else
+    {
+        screen_info->layer_head[c->stack_layer] = c->layer_next;
+    }
+    if (c->layer_next)
+    {
+        c->layer_next->layer_prev = c->layer_prev;
+    }
+    else
+    {
+        screen_info->layer_tail[c->stack_layer] = c->layer_prev;
+    }
+    c->layer_prev = NULL;
+    c->layer_next = NULL;
+}
+
+/* Place c in the stack just below above, or on top of everything if not stacked */
+static void
+clientStackInsert (Client *c, Client *above)
 {
     ScreenInfo *screen_info;
-    GList *list, *list2;
-    Client *c2;
 
-    g_return_val_if_fail (c != NULL, FALSE);
-    TRACE ("entering clientIsTopMost");
+    g_return_if_fail (c->stack_link == NULL);
 
     screen_info = c->screen_info;
+    if ((above) && (above->stack_link))
+    {
+        screen_info->windows_stack = g_list_insert_before (screen_info->windows_stack, above->stack_link, c);
+        c->stack_link = g_list_previous (above->stack_link);
+    }
+    else if (screen_info->stack_top)
+    {
+        /* Link after the last node, g_list_append() would walk the list */
+        c->stack_link = g_list_alloc ();
+        c->stack_link->data = c;
+        c->stack_link->prev = screen_info->stack_top;
+        screen_info->stack_top->next = c->stack_link;
+        screen_info->stack_top = c->stack_link;
+    }
+    else
+    {
+        screen_info->windows_stack = g_list_append (NULL, c);
+        c->stack_link = screen_info->windows_stack;
+        screen_info->stack_top = c->stack_link;
+    }
+
+    clientStackSetPosition (screen_info, c);
+    clientStackLinkLayer (screen_info, c);
+}
 
-    list = g_list_find (screen_info->windows_stack, (gconstpointer) c);
-    if (list)
+static void
+clientStackRemove (Client *c)
+{
+    ScreenInfo *screen_info;
+
+    if (c->stack_link == NULL)
     {
-        list2 = g_list_next (list);
-        while (list2)
+        return;
+    }
+
+    screen_info = c->screen_info;
+    clientStackUnlinkLayer (screen_info, c);
+    if (screen_info->stack_top == c->stack_link)
+    {
+        screen_info->stack_top = g_list_previous (c->stack_link);
+    }
+    screen_info->windows_stack = g_list_delete_link (screen_info->windows_stack, c->stack_link);
+    c->stack_link = NULL;
+}
+
+/* To be called when the layer of c changes, its place in the stack does not */
+void
+clientStackUpdateLayer (Client *c)
+{
+    ScreenInfo *screen_info;
+
+    g_return_if_fail (c != NULL);
+
+    screen_info = c->screen_info;
+    if ((c->stack_link) && (c->stack_layer != MIN (c->win_layer, WIN_LAYER_COUNT - 1)))
+    {
+        clientStackUnlinkLayer (screen_info, c);
+        clientStackLinkLayer (screen_info, c);
+    }
+}
+
+/*
+ * Lowest client in the stack on layer min_layer or above which passes
+ * the filter, if any. Only the start of each layer is looked at.
+ */
+Client *
+clientGetFirstInLayers (ScreenInfo *screen_info, guint min_layer,
+                        StackFilterFunc filter, gconstpointer data)
+{
+    Client *first, *c;
+    guint layer;
+
+    first = NULL;
+    for (layer = MIN (min_layer, WIN_LAYER_COUNT - 1); layer < WIN_LAYER_COUNT; layer++)
+    {
+        for (c = screen_info->layer_head[layer]; c; c = c->layer_next)
         {
-            c2 = (Client *) list2->data;
-            if (FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE) && (c2->win_layer == c->win_layer))
+            if ((c->win_layer >= min_layer) && ((filter == NULL) || filter (c, data)))
             {
-                return FALSE;
+                if ((first == NULL) || (c->stack_position < first->stack_position))
+                {
+                    first = c;
+                }
+                break;
             }
-            list2 = g_list_next (list2);
         }
     }
-    return TRUE;
+
+    return first;
 }
 
-Client *
-clientGetNextTopMost (ScreenInfo *screen_info, guint layer, Client * exclude)
+/* Topmost node of windows_stack, without walking it */
+GList *
+clientGetStackTop (ScreenInfo *screen_info)
 {
-    Client *top, *c;
-    GList *list;
+    return screen_info->stack_top;
+}
 
-    TRACE ("entering clientGetNextTopMost");
+/* Node of c in windows_stack, NULL if c is not in the stack */
+GList *
+clientGetStackLink (Client *c)
+{
+    return c->stack_link;
+}
 
-    top = NULL;
-    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+static gboolean
+clientIsNotExcluded (Client *c, gconstpointer exclude)
+{
+    return (c != (Client *) exclude);
+}
+
+gboolean
+clientIsTopMost (Client *c)
+{
+    Client *c2;
+
+    g_return_val_if_fail (c != NULL, FALSE);
+    TRACE ("entering clientIsTopMost");
+
+    if (clientGetStackLink (c))
     {
-        c = (Client *) list->data;
-        TRACE ("*** stack window \"%s\" (0x%lx), layer %i", c->name, c->window, (int) c->win_layer);
-        if (!exclude || (c != exclude))
+        /* Only the clients of the same layer matter */
+        for (c2 = c->layer_next; c2; c2 = c2->layer_next)
         {
-            if (c->win_layer > layer)
+            if (FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE) && (c2->win_layer == c->win_layer))
             {
-                top = c;
-                break;
+                return FALSE;
             }
         }
     }
+    return TRUE;
+}
+
+Client *
+clientGetNextTopMost (ScreenInfo *screen_info, guint layer, Client * exclude)
+{
+    TRACE ("entering clientGetNextTopMost");
 
-    return top;
+    return clientGetFirstInLayers (screen_info, layer + 1, clientIsNotExcluded, exclude);
 }
 
 Client *
 clientGetBottomMost (ScreenInfo *screen_info, guint layer, Client * exclude)
 {
-    Client *bot, *c;
+    Client *top;
     GList *list;
 
     TRACE ("entering clientGetBottomMost");
 
-    bot = NULL;
-    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+    /*
+     * Every window below the first one on that layer or above is
+     * on a lower layer, so the answer is just below it.
+     */
+    top = clientGetFirstInLayers (screen_info, layer, clientIsNotExcluded, exclude);
+    if (top)
     {
-        c = (Client *) list->data;
-        if (c)
-        {
-            TRACE ("*** stack window \"%s\" (0x%lx), layer %i", c->name,
-                c->window, (int) c->win_layer);
-            if (!exclude || (c != exclude))
-            {
-                if (c->win_layer < layer)
-                {
-                    bot = c;
-                }
-                else if (c->win_layer >= layer)
-                {
-                    break;
-                }
-            }
-        }
+        list = g_list_previous (top->stack_link);
+    }
+    else
+    {
+        list = screen_info->stack_top;
     }
-    return bot;
+    if ((list) && (list->data == (gpointer) exclude))
+    {
+        list = g_list_previous (list);
+    }
+
+    return (list ? (Client *) list->data : NULL);
 }
 
 /*
@@ -315,7 +646,7 @@ clientRaise (Client * c, Window wsibling)
      * by clicking inside.
      */
 
-    if (g_list_length (screen_info->windows_stack) < 1)
+    if (screen_info->windows_stack == NULL)
     {
         return;
     }
@@ -330,7 +661,7 @@ clientRaise (Client * c, Window wsibling)
             c2 = myDisplayGetClientFromWindow (display_info, wsibling, SEARCH_FRAME | SEARCH_WINDOW);
             if (c2)
             {
-                sibling = g_list_find (screen_info->windows_stack, (gconstpointer) c2);
+                sibling = c2->stack_link;
                 if (sibling)
                 {
                     list1 = g_list_next (sibling);
@@ -350,19 +681,16 @@ clientRaise (Client * c, Window wsibling)
         {
             client_sibling = clientGetNextTopMost (screen_info, c->win_layer, c);
         }
-        screen_info->windows_stack = g_list_remove (screen_info->windows_stack, (gconstpointer) c);
-        if (client_sibling)
+        if (client_sibling == c)
         {
-            /* If there is one, look for its place in the list */
-            sibling = g_list_find (screen_info->windows_stack, (gconstpointer) client_sibling);
-            /* Place the raised window just before it */
-            screen_info->windows_stack = g_list_insert_before (screen_info->windows_stack, sibling, c);
-        }
-        else
-        {
-            /* There will be no window on top of the raised window, so place it at the end of list */
-            screen_info->windows_stack = g_list_append (screen_info->windows_stack, c);
+            client_sibling = NULL;
         }
+        /*
+         * Place the raised window just before its sibling, if there is
+         * one, or at the end of list otherwise
+         */
+        clientStackRemove (c);
+        clientStackInsert (c, client_sibling);
         /* Now, look for transients, transients of transients, etc. */
         for (list1 = windows_stack_copy; list1; list1 = g_list_next (list1))
         {
@@ -372,21 +700,15 @@ clientRaise (Client * c, Window wsibling)
                 if ((c2 != c) && clientIsTransientOrModalFor (c2, c) && (c2->win_layer <= c->win_layer))
                 {
                     transients = g_list_append (transients, c2);
-                    if (sibling)
-                    {
-                        /* Make sure client_sibling is not c2 otherwise we create a circular linked list */
-                        if (client_sibling != c2)
-                        {
-                            /* Place the transient window just before sibling */
-                            screen_info->windows_stack = g_list_remove (screen_info->windows_stack, (gconstpointer) c2);
-                            screen_info->windows_stack = g_list_insert_before (screen_info->windows_stack, sibling, c2);
-                        }
-                    }
-                    else
+                    /*
+                     * Place the transient window just before sibling, or at the end
+                     * of list, making sure client_sibling is not c2 otherwise we
+                     * create a circular linked list
+                     */
+                    if (client_sibling != c2)
                     {
-                        /* There will be no window on top of the transient window, so place it at the end of list */
-                        screen_info->windows_stack = g_list_remove (screen_info->windows_stack, (gconstpointer) c2);
-                        screen_info->windows_stack = g_list_append (screen_info->windows_stack, c2);
+                        clientStackRemove (c2);
+                        clientStackInsert (c2, client_sibling);
                     }
                 }
                 else
@@ -397,21 +719,11 @@ clientRaise (Client * c, Window wsibling)
                         if ((c3 != c2) && clientIsTransientOrModalFor (c2, c3))
                         {
                             transients = g_list_append (transients, c2);
-                            if (sibling)
+                            /* Again, before sibling or at the end of list */
+                            if (client_sibling != c2)
                             {
-                                /* Again, make sure client_sibling is not c2 to avoid a circular linked list */
-                                if (client_sibling != c2)
-                                {
-                                    /* Place the transient window just before sibling */
-                                    screen_info->windows_stack = g_list_remove (screen_info->windows_stack, (gconstpointer) c2);
-                                    screen_info->windows_stack = g_list_insert_before (screen_info->windows_stack, sibling, c2);
-                                }
-                            }
-                            else
-                            {
-                                /* There will be no window on top of the transient window, so place it at the end of list */
-                                screen_info->windows_stack = g_list_remove (screen_info->windows_stack, (gconstpointer) c2);
-                                screen_info->windows_stack = g_list_append (screen_info->windows_stack, c2);
+                                clientStackRemove (c2);
+                                clientStackInsert (c2, client_sibling);
                             }
                             break;
                         }
@@ -431,7 +743,7 @@ clientRaise (Client * c, Window wsibling)
            We still need to tell the X Server to reflect the changes
          */
         clientApplyStackList (screen_info);
-        clientSetNetClientList (c->screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING], screen_info->windows_stack);
+        clientSetNetClientList (c->screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING]);
         screen_info->last_raise = c;
     }
 }
@@ -444,7 +756,6 @@ clientLower (Client * c, Window wsibling)
     Client *c2, *client_sibling;
     GList *sibling;
     GList *list;
-    gint position;
 
     g_return_if_fail (c != NULL);
 
@@ -457,7 +768,7 @@ clientLower (Client * c, Window wsibling)
     sibling = NULL;
     c2 = NULL;
 
-    if (g_list_length (screen_info->windows_stack) < 1)
+    if (screen_info->windows_stack == NULL)
     {
         return;
     }
@@ -477,7 +788,7 @@ clientLower (Client * c, Window wsibling)
             c2 = myDisplayGetClientFromWindow (display_info, wsibling, SEARCH_FRAME | SEARCH_WINDOW);
             if (c2)
             {
-                sibling = g_list_find (screen_info->windows_stack, (gconstpointer) c2);
+                sibling = c2->stack_link;
                 if (sibling)
                 {
                     list = g_list_previous (sibling);
@@ -500,27 +811,30 @@ clientLower (Client * c, Window wsibling)
         }
         if (client_sibling != c)
         {
-            screen_info->windows_stack = g_list_remove (screen_info->windows_stack, (gconstpointer) c);
+            clientStackRemove (c);
             /* Paranoid check to avoid circular linked list */
-            if (client_sibling)
+            if ((client_sibling) && (client_sibling->stack_link))
             {
-                sibling = g_list_find (screen_info->windows_stack, (gconstpointer) client_sibling);
-                position = g_list_position (screen_info->windows_stack, sibling) + 1;
-
-                screen_info->windows_stack = g_list_insert (screen_info->windows_stack, c, position);
-                TRACE ("lowest client is \"%s\" (0x%lx) at position %i",
-                        client_sibling->name, client_sibling->window, position);
+                /* Just above client_sibling, that is below whatever follows it */
+                list = g_list_next (client_sibling->stack_link);
+                clientStackInsert (c, (list ? (Client *) list->data : NULL));
+                TRACE ("lowest client is \"%s\" (0x%lx)",
+                        client_sibling->name, client_sibling->window);
+            }
+            else if (screen_info->windows_stack)
+            {
+                clientStackInsert (c, (Client *) screen_info->windows_stack->data);
             }
             else
             {
-                screen_info->windows_stack = g_list_prepend (screen_info->windows_stack, c);
+                clientStackInsert (c, NULL);
             }
         }
         /* Now, screen_info->windows_stack contains the correct window stack
            We still need to tell the X Server to reflect the changes
          */
         clientApplyStackList (screen_info);
-        clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING], screen_info->windows_stack);
+        clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING]);
         clientPassFocus (screen_info, c, NULL);
         if (screen_info->last_raise == c)
         {
@@ -587,9 +901,11 @@ clientAddToList (Client * c)
 
     TRACE ("adding window \"%s\" (0x%lx) to windows list", c->name, c->window);
     screen_info->windows = g_list_append (screen_info->windows, c);
-    screen_info->windows_stack = g_list_append (screen_info->windows_stack, c);
+    clientStackInsert (c, NULL);
+    clientTransientsAdd (c);
+    workspaceAddClient (c);
 
-    clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST], screen_info->windows);
+    clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST]);
 
     FLAG_SET (c->xfwm_flags, XFWM_FLAG_MANAGED);
 }
@@ -599,6 +915,7 @@ clientRemoveFromList (Client * c)
 {
     ScreenInfo *screen_info;
     DisplayInfo *display_info;
+    guint i;
 
     g_return_if_fail (c != NULL);
     TRACE ("entering clientRemoveFromList");
@@ -608,6 +925,8 @@ clientRemoveFromList (Client * c)
     screen_info = c->screen_info;
     display_info = screen_info->display_info;
     myDisplayRemoveClient (display_info, c);
+    clientTransientsRemove (c);
+    workspaceRemoveClient (c);
 
     g_assert (screen_info->client_count > 0);
     screen_info->client_count--;
@@ -629,10 +948,20 @@ clientRemoveFromList (Client * c)
     screen_info->windows = g_list_remove (screen_info->windows, c);
 
     TRACE ("removing window \"%s\" (0x%lx) from screen_info->windows_stack list", c->name, c->window);
-    screen_info->windows_stack = g_list_remove (screen_info->windows_stack, c);
+    clientStackRemove (c);
+
+    /* The frame is going away, do not consider it as stacked anymore */
+    for (i = 0; i < screen_info->applied_count; i++)
+    {
+        if (screen_info->applied_stack[i] == c->frame)
+        {
+            screen_info->applied_stack[i] = None;
+            break;
+        }
+    }
 
-    clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST], screen_info->windows);
-    clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING], screen_info->windows_stack);
+    clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST]);
+    clientSetNetClientList (screen_info, display_info->atoms[NET_CLIENT_LIST_STACKING]);
 
     FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_MANAGED);
 }
@@ -31,7 +31,16 @@
 #include "screen.h"
 #include "client.h"
 
+typedef gboolean (*StackFilterFunc) (Client *, gconstpointer);
+
 void                     clientApplyStackList                   (ScreenInfo *);
+Client                  *clientGetFirstInLayers                 (ScreenInfo *,
+                                                                 guint,
+                                                                 StackFilterFunc,
+                                                                 gconstpointer);
+GList                   *clientGetStackTop                      (ScreenInfo *);
+GList                   *clientGetStackLink                     (Client *);
+void                     clientStackUpdateLayer                 (Client *);
 Client                  *clientGetLowestTransient               (Client *);
 Client                  *clientGetHighestTransientOrModalFor    (Client *);
 gboolean                 clientIsTopMost                        (Client *);
@@ -0,0 +1,267 @@
+/*      $Id$
+
+        This program is free software; you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation; either version 2, or (at your option)
+        any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program; if not, write to the Free Software
+        Foundation, Inc., Inc., 51 Franklin Street, Fifth Floor, Boston,
+        MA 02110-1301, USA.
+
+
+        xfwm4    - (c) 2002-2011 Olivier Fourdan
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <X11/X.h>
+#include <X11/Xlib.h>
+#include <glib.h>
+#include <string.h>
+#include <libxfce4util/libxfce4util.h>
+
+#include "client.h"
+#include "display.h"
+#include "hints.h"
+#include "screen.h"
+#include "stats.h"
+
+/*
+ * Runtime counters, published as a JSON string in the XFWM4_STATS
+ * property of the xfwm4 window of each screen, e.g.
+ *   xprop -id <xfwm4 window> XFWM4_STATS
+ * The property is refreshed at most once per STATS_PUBLISH_INTERVAL,
+ * and only when something changed.
+ */
+
+#define STATS_PUBLISH_INTERVAL 1000 /* ms */
+
+/* Latencies are sorted in power of two buckets, from < 1us to >= 32ms */
+#define STATS_BUCKETS 16
+
+/* Slot 0 gathers the extension events (damage, sync, shape...) */
+#define STATS_EVENT_TYPES 36
+
+typedef struct _StatsTiming StatsTiming;
+struct _StatsTiming
+{
+    guint count;
+    gint64 total;
+    gint64 max;
+    guint buckets[STATS_BUCKETS];
+};
+
+static const gchar *event_names[STATS_EVENT_TYPES] = {
+    "Extension", NULL, "KeyPress", "KeyRelease", "ButtonPress",
+    "ButtonRelease", "MotionNotify", "EnterNotify", "LeaveNotify",
+    "FocusIn", "FocusOut", "KeymapNotify", "Expose", "GraphicsExpose",
+    "NoExpose", "VisibilityNotify", "CreateNotify", "DestroyNotify",
+    "UnmapNotify", "MapNotify", "MapRequest", "ReparentNotify",
+    "ConfigureNotify", "ConfigureRequest", "GravityNotify", "ResizeRequest",
+    "CirculateNotify", "CirculateRequest", "PropertyNotify", "SelectionClear",
+    "SelectionRequest", "SelectionNotify", "ColormapNotify", "ClientMessage",
+    "MappingNotify", "GenericEvent"
+};
+
+static const gchar *timing_names[STATS_TIMING_COUNT] = {
+    "paint_all", "client_frame"
+};
+
+static const gchar *counter_names[STATS_COUNTER_COUNT] = {
+    "client_configure", "xsync", "get_window_property", "prefetch_property",
+    "query_pointer"
+};
+
+static DisplayInfo *stats_display = NULL;
+static StatsTiming stats_events[STATS_EVENT_TYPES];
+static StatsTiming stats_timings[STATS_TIMING_COUNT];
+static guint stats_counters[STATS_COUNTER_COUNT];
+static guint stats_timeout_id = 0;
+
+/* Deferred work queued in the main loop, idles and repaint/unredirect timeouts */
+static guint
+statsCountPendingIdles (DisplayInfo *display_info)
+{
+    ScreenInfo *screen_info;
+    GSList *screens;
+    Client *c;
+    guint pending, i;
+
+    pending = (display_info->pending_idle_id != 0);
+    for (screens = display_info->screens; screens; screens = g_slist_next (screens))
+    {
+        screen_info = (ScreenInfo *) screens->data;
+        pending += (screen_info->frame_idle_id != 0);
+        pending += (screen_info->client_list_idle_id != 0);
+#ifdef HAVE_COMPOSITOR
+        pending += (screen_info->compositor_timeout_id != 0);
+        pending += (screen_info->unredirect_timeout_id != 0);
+#endif /* HAVE_COMPOSITOR */
+        for (c = screen_info->clients, i = 0; i < screen_info->client_count; c = c->next, i++)
+        {
+            pending += (c->icon_timeout_id != 0);
+        }
+    }
+
+    return pending;
+}
+
+static void
+statsAppendTiming (GString *json, const gchar *name, StatsTiming *timing)
+{
+    guint i;
+
+    g_string_append_printf (json, "\"%s\":{\"count\":%u,\"total_us\":%" G_GINT64_FORMAT
+                                  ",\"max_us\":%" G_GINT64_FORMAT ",\"histogram\":[",
+                            name, timing->count, timing->total, timing->max);
+    for (i = 0; i < STATS_BUCKETS; i++)
+    {
+        if (i)
+        {
+            g_string_append_c (json, ',');
+        }
+        g_string_append_printf (json, "%u", timing->buckets[i]);
+    }
+    g_string_append (json, "]}");
+}
+
+static gboolean
+stats_publish_cb (gpointer data)
+{
+    ScreenInfo *screen_info;
+    GString *json;
+    GSList *screens;
+    gboolean first;
+    guint i;
+
+    TRACE ("entering stats_publish_cb");
+
+    stats_timeout_id = 0;
+    if (!stats_display)
+    {
+        return (FALSE);
+    }
+
+    json = g_string_sized_new (2048);
+    g_string_append (json, "{\"events\":{");
+    for (i = 0, first = TRUE; i < STATS_EVENT_TYPES; i++)
+    {
+        if ((event_names[i] == NULL) || (stats_events[i].count == 0))
+        {
+            continue;
+        }
+        if (!first)
+        {
+            g_string_append_c (json, ',');
+        }
+        statsAppendTiming (json, event_names[i], &stats_events[i]);
+        first = FALSE;
+    }
+    g_string_append (json, "}");
+    for (i = 0; i < STATS_TIMING_COUNT; i++)
+    {
+        g_string_append_c (json, ',');
+        statsAppendTiming (json, timing_names[i], &stats_timings[i]);
+    }
+    for (i = 0; i < STATS_COUNTER_COUNT; i++)
+    {
+        g_string_append_printf (json, ",\"%s\":%u", counter_names[i], stats_counters[i]);
+    }
+    g_string_append_printf (json, ",\"idle_pending\":%u}", statsCountPendingIdles (stats_display));
+
+    for (screens = stats_display->screens; screens; screens = g_slist_next (screens))
+    {
+        screen_info = (ScreenInfo *) screens->data;
+        setUTF8StringHint (stats_display, screen_info->xfwm4_win, XFWM4_STATS, json->str);
+    }
+    g_string_free (json, TRUE);
+
+    return (FALSE);
+}
+
+static void
+statsChanged (void)
+{
+    if ((stats_display) && (stats_timeout_id == 0))
+    {
+        stats_timeout_id = g_timeout_add (STATS_PUBLISH_INTERVAL, stats_publish_cb, NULL);
+    }
+}
+
+static void
+statsTimingAdd (StatsTiming *timing, gint64 elapsed)
+{
+    guint bucket;
+
+    elapsed = MAX (elapsed, 0);
+    timing->count++;
+    timing->total += elapsed;
+    timing->max = MAX (timing->max, elapsed);
+    for (bucket = 0; (bucket < STATS_BUCKETS - 1) && (elapsed >= (G_GINT64_CONSTANT (1) << bucket)); bucket++);
+    timing->buckets[bucket]++;
+}
+
+void
+statsInit (DisplayInfo *display_info)
+{
+    g_return_if_fail (display_info != NULL);
+    TRACE ("entering statsInit");
+
+    memset (stats_events, 0, sizeof (stats_events));
+    memset (stats_timings, 0, sizeof (stats_timings));
+    memset (stats_counters, 0, sizeof (stats_counters));
+    stats_display = display_info;
+    statsChanged ();
+}
+
+void
+statsClose (DisplayInfo *display_info)
+{
+    TRACE ("entering statsClose");
+
+    if (stats_timeout_id)
+    {
+        g_source_remove (stats_timeout_id);
+        stats_timeout_id = 0;
+    }
+    stats_display = NULL;
+}
+
+void
+statsCount (statsCounter counter)
+{
+    g_return_if_fail (counter < STATS_COUNTER_COUNT);
+
+    stats_counters[counter]++;
+    statsChanged ();
+}
+
+void
+statsEvent (int type, gint64 elapsed)
+{
+    if ((type < 0) || (type >= STATS_EVENT_TYPES) || (event_names[type] == NULL))
+    {
+        type = 0;
+    }
+    statsTimingAdd (&stats_events[type], elapsed);
+    statsChanged ();
+}
+
+void
+statsTime (statsTiming timing, gint64 elapsed)
+{
+    g_return_if_fail (timing < STATS_TIMING_COUNT);
+
+    statsTimingAdd (&stats_timings[timing], elapsed);
+    statsChanged ();
+}
@@ -0,0 +1,62 @@
+/*      $Id$
+
+        This program is free software; you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation; either version 2, or (at your option)
+        any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program; if not, write to the Free Software
+        Foundation, Inc., Inc., 51 Franklin Street, Fifth Floor, Boston,
+        MA 02110-1301, USA.
+
+
+        xfwm4    - (c) 2002-2011 Olivier Fourdan
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <X11/Xlib.h>
+#include <glib.h>
+
+#include "display.h"
+
+#ifndef INC_STATS_H
+#define INC_STATS_H
+
+typedef enum
+{
+    STATS_CLIENT_CONFIGURE = 0,
+    STATS_XSYNC,
+    STATS_GET_PROPERTY,
+    STATS_PREFETCH_PROPERTY,
+    STATS_QUERY_POINTER,
+    STATS_COUNTER_COUNT
+}
+statsCounter;
+
+typedef enum
+{
+    STATS_PAINT = 0,
+    STATS_CLIENT_FRAME,
+    STATS_TIMING_COUNT
+}
+statsTiming;
+
+void                     statsInit                              (DisplayInfo *);
+void                     statsClose                             (DisplayInfo *);
+void                     statsCount                             (statsCounter);
+void                     statsEvent                             (int,
+                                                                 gint64);
+void                     statsTime                              (statsTiming,
+                                                                 gint64);
+
+#endif /* INC_STATS_H */
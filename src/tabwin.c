@@ -40,7 +40,7 @@
 #include <gdk/gdk.h>
 #include <gtk/gtk.h>
 #include <libxfce4util/libxfce4util.h>
-#include "icons.h"
+#include "client.h"
 #include "focus.h"
 #include "tabwin.h"
 
@@ -214,7 +214,7 @@ createWindowIcon (Client *c, gint icon_size)
     g_return_val_if_fail (c, NULL);
     TRACE ("entering createWindowIcon");
 
-    icon_pixbuf = getAppIcon (c->screen_info->display_info, c->window, icon_size, icon_size);
+    icon_pixbuf = clientGetIcon (c, icon_size);
     icon_pixbuf_stated = NULL;
     icon = gtk_image_new ();
     g_object_set_data (G_OBJECT (icon), "client-ptr-val", c);
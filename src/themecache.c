@@ -0,0 +1,417 @@
+/*      $Id$
+
+        This program is free software; you can redistribute it and/or modify
+        it under the terms of the GNU General Public License as published by
+        the Free Software Foundation; either version 2, or (at your option)
+        any later version.
+
+        This program is distributed in the hope that it will be useful,
+        but WITHOUT ANY WARRANTY; without even the implied warranty of
+        MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+        GNU General Public License for more details.
+
+        You should have received a copy of the GNU General Public License
+        along with this program; if not, write to the Free Software
+        Foundation, Inc., Inc., 51 Franklin Street, Fifth Floor, Boston,
+        MA 02110-1301, USA.
+
+
+        xfwm4    - (c) 2002-2011 Olivier Fourdan
+
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gdk-pixbuf/gdk-pixbuf.h>
+#include <libxfce4util/libxfce4util.h>
+#include <string.h>
+
+#include "mypixmap.h"
+#include "themecache.h"
+
+/*
+ * Decoded theme parts are kept in $XDG_CACHE_HOME/xfwm4, one file per
+ * theme directory. The file starts with a key built from the theme path,
+ * the size and mtime of the theme files and the gtk color symbols, so
+ * that any change to either invalidates the cache. A valid file is
+ * mapped and its parts are handed out as pixbufs pointing straight into
+ * the mapping, which avoids parsing the XPM files and probing the other
+ * image formats for every part.
+ *
+ * Parts that the theme does not provide are recorded too (with a zero
+ * width) so that a cache hit never has to look for them again.
+ */
+
+#define THEME_CACHE_MAGIC      "XFWMTC01"
+#define THEME_CACHE_NAME_SIZE  32
+#define THEME_CACHE_ALIGN(x)   (((x) + 3) & ~3)
+
+typedef struct
+{
+    gchar magic[8];
+    guint32 key_length;
+    guint32 n_parts;
+}
+ThemeCacheHeader;
+
+typedef struct
+{
+    gchar name[THEME_CACHE_NAME_SIZE];
+    guint32 width;
+    guint32 height;
+    guint32 rowstride;
+    guint32 has_alpha;
+    guint32 offset;
+}
+ThemeCachePart;
+
+struct _ThemeCache
+{
+    gchar *filename;
+    gchar *key;
+    GMappedFile *mapped;
+    /* Parts found in the mapped file, by name */
+    GHashTable *parts;
+    /* Parts recorded on a miss, written out on close */
+    GArray *new_parts;
+    GByteArray *new_data;
+    gboolean stale;
+};
+
+static gchar *
+themeCacheKey (const gchar *dir, xfwmColorSymbol *cs)
+{
+    GString *key;
+    GDir *gdir;
+    const gchar *name;
+    gchar *filename;
+    struct stat st;
+    guint i;
+
+    gdir = g_dir_open (dir, 0, NULL);
+    if (!gdir)
+    {
+        return NULL;
+    }
+
+    /* One stat per file is still far cheaper than decoding them */
+    key = g_string_new (dir);
+    while ((name = g_dir_read_name (gdir)) != NULL)
+    {
+        filename = g_build_filename (dir, name, NULL);
+        if (g_stat (filename, &st) == 0)
+        {
+            g_string_append_printf (key, "|%s:%lu:%lu", name,
+                                    (gulong) st.st_size, (gulong) st.st_mtime);
+        }
+        g_free (filename);
+    }
+    g_dir_close (gdir);
+
+    for (i = 0; cs && cs[i].name; i++)
+    {
+        g_string_append_printf (key, "|%s=%s", cs[i].name,
+                                cs[i].value ? cs[i].value : "");
+    }
+
+    return g_string_free (key, FALSE);
+}
+
+static void
+themeCacheUnmap (ThemeCache *cache)
+{
+    if (cache->parts)
+    {
+        g_hash_table_destroy (cache->parts);
+        cache->parts = NULL;
+    }
+    if (cache->mapped)
+    {
+#if GLIB_CHECK_VERSION (2, 22, 0)
+        g_mapped_file_unref (cache->mapped);
+#else
+        g_mapped_file_free (cache->mapped);
+#endif
+        cache->mapped = NULL;
+    }
+}
+
+static gboolean
+themeCacheMap (ThemeCache *cache)
+{
+    const ThemeCacheHeader *header;
+    const ThemeCachePart *part;
+    const gchar *data;
+    gsize length, offset;
+    guint64 end;
+    guint key_length, channels;
+    guint i;
+
+    cache->mapped = g_mapped_file_new (cache->filename, FALSE, NULL);
+    if (!cache->mapped)
+    {
+        return FALSE;
+    }
+
+    data = g_mapped_file_get_contents (cache->mapped);
+    length = g_mapped_file_get_length (cache->mapped);
+    key_length = strlen (cache->key);
+
+    if (length < sizeof (ThemeCacheHeader))
+    {
+        themeCacheUnmap (cache);
+        return FALSE;
+    }
+
+    header = (const ThemeCacheHeader *) data;
+    offset = sizeof (ThemeCacheHeader) + THEME_CACHE_ALIGN (key_length);
+    if ((memcmp (header->magic, THEME_CACHE_MAGIC, sizeof (header->magic)) != 0) ||
+        (header->key_length != key_length) ||
+        (length < offset + (guint64) header->n_parts * sizeof (ThemeCachePart)) ||
+        (memcmp (data + sizeof (ThemeCacheHeader), cache->key, key_length) != 0))
+    {
+        TRACE ("theme cache \"%s\" is out of date", cache->filename);
+        themeCacheUnmap (cache);
+        return FALSE;
+    }
+
+    cache->parts = g_hash_table_new (g_str_hash, g_str_equal);
+    part = (const ThemeCachePart *) (data + offset);
+    for (i = 0; i < header->n_parts; i++, part++)
+    {
+        if (part->name[THEME_CACHE_NAME_SIZE - 1] != '\0')
+        {
+            break;
+        }
+        if (part->width)
+        {
+            channels = part->has_alpha ? 4 : 3;
+            end = (guint64) part->offset + (guint64) part->rowstride * part->height;
+            if ((part->rowstride < part->width * channels) || (end > length))
+            {
+                break;
+            }
+        }
+        g_hash_table_insert (cache->parts, (gpointer) part->name, (gpointer) part);
+    }
+
+    if (i < header->n_parts)
+    {
+        g_warning ("Theme cache \"%s\" is corrupted", cache->filename);
+        themeCacheUnmap (cache);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+ThemeCache *
+themeCacheOpen (const gchar *dir, xfwmColorSymbol *cs)
+{
+    ThemeCache *cache;
+    gchar *cachedir;
+    gchar *basename;
+    gchar *key;
+
+    TRACE ("entering themeCacheOpen");
+
+    g_return_val_if_fail (dir != NULL, NULL);
+
+    key = themeCacheKey (dir, cs);
+    if (!key)
+    {
+        return NULL;
+    }
+
+    cachedir = xfce_resource_save_location (XFCE_RESOURCE_CACHE,
+                                            "xfwm4" G_DIR_SEPARATOR_S, TRUE);
+    if (!cachedir)
+    {
+        g_free (key);
+        return NULL;
+    }
+
+    cache = g_new0 (ThemeCache, 1);
+    cache->key = key;
+    basename = g_strdup_printf ("theme-%08x.cache", g_str_hash (dir));
+    cache->filename = g_build_filename (cachedir, basename, NULL);
+    g_free (basename);
+    g_free (cachedir);
+
+    if (!themeCacheMap (cache))
+    {
+        cache->new_parts = g_array_new (FALSE, TRUE, sizeof (ThemeCachePart));
+        cache->new_data = g_byte_array_new ();
+    }
+
+    return cache;
+}
+
+/*
+ * Returns TRUE when the cache knows about the part, in which case
+ * pixbuf is either the cached image or NULL if the theme does not
+ * provide that part. The pixbuf data belongs to the cache, it must be
+ * released before themeCacheClose().
+ */
+gboolean
+themeCacheLookup (ThemeCache *cache, const gchar *name, GdkPixbuf **pixbuf)
+{
+    const ThemeCachePart *part;
+    const gchar *data;
+
+    g_return_val_if_fail (pixbuf != NULL, FALSE);
+
+    *pixbuf = NULL;
+    if ((cache == NULL) || (cache->parts == NULL))
+    {
+        return FALSE;
+    }
+
+    part = g_hash_table_lookup (cache->parts, name);
+    if (!part)
+    {
+        /* Unknown part, rebuild the cache next time */
+        cache->stale = TRUE;
+        return FALSE;
+    }
+
+    if (part->width)
+    {
+        data = g_mapped_file_get_contents (cache->mapped);
+        *pixbuf = gdk_pixbuf_new_from_data ((const guchar *) data + part->offset,
+                                            GDK_COLORSPACE_RGB, part->has_alpha, 8,
+                                            part->width, part->height,
+                                            part->rowstride, NULL, NULL);
+    }
+
+    return TRUE;
+}
+
+void
+themeCacheStore (ThemeCache *cache, const gchar *name, GdkPixbuf *pixbuf)
+{
+    ThemeCachePart part;
+    const guchar *pixels;
+    guint row, rowstride;
+
+    if ((cache == NULL) || (cache->new_parts == NULL))
+    {
+        return;
+    }
+
+    memset (&part, 0, sizeof (ThemeCachePart));
+    if (strlen (name) >= THEME_CACHE_NAME_SIZE)
+    {
+        cache->stale = TRUE;
+        return;
+    }
+    strcpy (part.name, name);
+
+    if (pixbuf)
+    {
+        if ((gdk_pixbuf_get_colorspace (pixbuf) != GDK_COLORSPACE_RGB) ||
+            (gdk_pixbuf_get_bits_per_sample (pixbuf) != 8) ||
+            (gdk_pixbuf_get_n_channels (pixbuf) != (gdk_pixbuf_get_has_alpha (pixbuf) ? 4 : 3)))
+        {
+            cache->stale = TRUE;
+            return;
+        }
+
+        part.width = gdk_pixbuf_get_width (pixbuf);
+        part.height = gdk_pixbuf_get_height (pixbuf);
+        part.has_alpha = gdk_pixbuf_get_has_alpha (pixbuf);
+        part.rowstride = THEME_CACHE_ALIGN (part.width * (part.has_alpha ? 4 : 3));
+        /* Relative to the data block until the file is written */
+        part.offset = cache->new_data->len;
+
+        pixels = gdk_pixbuf_get_pixels (pixbuf);
+        rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+        g_byte_array_set_size (cache->new_data,
+                               cache->new_data->len + part.rowstride * part.height);
+        for (row = 0; row < part.height; row++)
+        {
+            /* The last row of a pixbuf may be shorter than its rowstride */
+            memcpy (cache->new_data->data + part.offset + row * part.rowstride,
+                    pixels + row * rowstride,
+                    part.width * (part.has_alpha ? 4 : 3));
+        }
+    }
+
+    g_array_append_val (cache->new_parts, part);
+}
+
+static void
+themeCacheWrite (ThemeCache *cache)
+{
+    ThemeCacheHeader header;
+    ThemeCachePart *part;
+    GByteArray *out;
+    GError *error;
+    guint key_length, base;
+    guint i;
+
+    key_length = strlen (cache->key);
+    base = sizeof (ThemeCacheHeader) + THEME_CACHE_ALIGN (key_length)
+         + cache->new_parts->len * sizeof (ThemeCachePart);
+
+    memset (&header, 0, sizeof (ThemeCacheHeader));
+    memcpy (header.magic, THEME_CACHE_MAGIC, sizeof (header.magic));
+    header.key_length = key_length;
+    header.n_parts = cache->new_parts->len;
+
+    out = g_byte_array_sized_new (base + cache->new_data->len);
+    g_byte_array_append (out, (guint8 *) &header, sizeof (ThemeCacheHeader));
+    g_byte_array_append (out, (guint8 *) cache->key, key_length);
+    g_byte_array_set_size (out, sizeof (ThemeCacheHeader) + THEME_CACHE_ALIGN (key_length));
+    for (i = 0; i < cache->new_parts->len; i++)
+    {
+        part = &g_array_index (cache->new_parts, ThemeCachePart, i);
+        part->offset += base;
+        g_byte_array_append (out, (guint8 *) part, sizeof (ThemeCachePart));
+    }
+    g_byte_array_append (out, cache->new_data->data, cache->new_data->len);
+
+    error = NULL;
+    if (!g_file_set_contents (cache->filename, (gchar *) out->data, out->len, &error))
+    {
+        g_warning ("Cannot write theme cache \"%s\": %s", cache->filename, error->message);
+        g_error_free (error);
+    }
+    g_byte_array_free (out, TRUE);
+}
+
+void
+themeCacheClose (ThemeCache *cache)
+{
+    TRACE ("entering themeCacheClose");
+
+    if (cache == NULL)
+    {
+        return;
+    }
+
+    if (cache->stale)
+    {
+        g_unlink (cache->filename);
+    }
+    else if (cache->new_parts)
+    {
+        themeCacheWrite (cache);
+    }
+
+    themeCacheUnmap (cache);
+    if (cache->new_parts)
+    {
+        g_array_free (cache->new_parts, TRUE);
+        g_byte_array_free (cache->new_data, TRUE);
+    }
+    g_free (cache->filename);
+    g_free (cache->key);
+    g_free (cache);
+}
@@ -29,6 +29,7 @@
 
 #include "screen.h"
 #include "client.h"
+#include "misc.h"
 #include "stacking.h"
 #include "transients.h"
 
@@ -202,6 +203,158 @@ clientIsTransientOrModalForGroup (Client * c)
     return (clientIsTransientForGroup(c) || clientIsModalForGroup(c));
 }
 
+typedef gboolean (*TransientTest) (Client *, Client *);
+
+/*
+ * The transients index files every managed client under its
+ * transient_for window and its group leader, so the family of a
+ * client can be found without walking the whole stack.
+ */
+void
+clientTransientsAdd (Client * c)
+{
+    ScreenInfo *screen_info;
+
+    g_return_if_fail (c != NULL);
+    TRACE ("entering clientTransientsAdd");
+
+    screen_info = c->screen_info;
+    c->indexed_transient_for = c->transient_for;
+    c->indexed_group_leader = c->group_leader;
+
+    if ((c->indexed_transient_for != None) && (c->indexed_transient_for != screen_info->xroot))
+    {
+        multimapInsert (screen_info->transients_index, (gpointer) c->indexed_transient_for, c);
+    }
+    if (c->indexed_group_leader != None)
+    {
+        multimapInsert (screen_info->groups_index, (gpointer) c->indexed_group_leader, c);
+    }
+}
+
+void
+clientTransientsRemove (Client * c)
+{
+    ScreenInfo *screen_info;
+
+    g_return_if_fail (c != NULL);
+    TRACE ("entering clientTransientsRemove");
+
+    screen_info = c->screen_info;
+    if ((c->indexed_transient_for != None) && (c->indexed_transient_for != screen_info->xroot))
+    {
+        multimapRemove (screen_info->transients_index, (gpointer) c->indexed_transient_for, c);
+    }
+    if (c->indexed_group_leader != None)
+    {
+        multimapRemove (screen_info->groups_index, (gpointer) c->indexed_group_leader, c);
+    }
+    c->indexed_transient_for = None;
+    c->indexed_group_leader = None;
+}
+
+/* To be called whenever transient_for or group_leader change */
+void
+clientTransientsUpdate (Client * c)
+{
+    g_return_if_fail (c != NULL);
+
+    if (!FLAG_TEST (c->xfwm_flags, XFWM_FLAG_MANAGED))
+    {
+        /* Not indexed yet, clientAddToList() will take care of it */
+        return;
+    }
+    if ((c->indexed_transient_for == c->transient_for) &&
+        (c->indexed_group_leader == c->group_leader))
+    {
+        return;
+    }
+    clientTransientsRemove (c);
+    clientTransientsAdd (c);
+}
+
+static void
+clientAddCandidates (GSList **candidates, GHashTable *index, Window w)
+{
+    GSList *entries;
+
+    if (w == None)
+    {
+        return;
+    }
+    for (entries = multimapLookup (index, (gconstpointer) w); entries; entries = g_slist_next (entries))
+    {
+        *candidates = g_slist_prepend (*candidates, entries->data);
+    }
+}
+
+/* Clients that may be transient for c, a superset checked by the caller */
+static GSList *
+clientListChildCandidates (Client * c)
+{
+    ScreenInfo *screen_info;
+    GSList *candidates;
+    Client *leader;
+
+    screen_info = c->screen_info;
+    candidates = NULL;
+    clientAddCandidates (&candidates, screen_info->transients_index, c->window);
+    if (c->transient_for == None)
+    {
+        /* Transients for group, see clientIsTransientFor() and clientSameGroup() */
+        clientAddCandidates (&candidates, screen_info->groups_index, c->group_leader);
+        clientAddCandidates (&candidates, screen_info->groups_index, c->window);
+        if ((c->group_leader != None) && (c->group_leader != c->window))
+        {
+            leader = myScreenGetClientFromWindow (screen_info, c->group_leader, SEARCH_WINDOW);
+            if (leader)
+            {
+                candidates = g_slist_prepend (candidates, leader);
+            }
+        }
+    }
+
+    return candidates;
+}
+
+/* Clients c may be transient for, a superset checked by the caller */
+static GSList *
+clientListParentCandidates (Client * c)
+{
+    ScreenInfo *screen_info;
+    GSList *candidates;
+    Client *c2;
+
+    screen_info = c->screen_info;
+    candidates = NULL;
+    if (c->transient_for == None)
+    {
+        return NULL;
+    }
+    if (c->transient_for != screen_info->xroot)
+    {
+        c2 = myScreenGetClientFromWindow (screen_info, c->transient_for, SEARCH_WINDOW);
+        if (c2)
+        {
+            candidates = g_slist_prepend (candidates, c2);
+        }
+        return candidates;
+    }
+
+    clientAddCandidates (&candidates, screen_info->groups_index, c->group_leader);
+    clientAddCandidates (&candidates, screen_info->groups_index, c->window);
+    if ((c->group_leader != None) && (c->group_leader != c->window))
+    {
+        c2 = myScreenGetClientFromWindow (screen_info, c->group_leader, SEARCH_WINDOW);
+        if (c2)
+        {
+            candidates = g_slist_prepend (candidates, c2);
+        }
+    }
+
+    return candidates;
+}
+
 gboolean
 clientIsValidTransientOrModal (Client * c)
 {
@@ -210,22 +363,25 @@ clientIsValidTransientOrModal (Client * c)
     TRACE ("entering clientIsValidTransientOrModal");
     if (clientIsTransientOrModalForGroup (c))
     {
-        ScreenInfo *screen_info = c->screen_info;
-        GList *list;
+        GSList *candidates, *list;
+        gboolean found;
 
         /* Look for a valid transient or modal for the same group */
-        for (list = screen_info->windows_stack; list; list = g_list_next (list))
+        found = FALSE;
+        candidates = clientListParentCandidates (c);
+        for (list = candidates; list; list = g_slist_next (list))
         {
             Client *c2 = (Client *) list->data;
-            if (c2 != c)
+            if ((c2 != c) && clientIsTransientOrModalFor (c, c2))
             {
-                if (clientIsTransientOrModalFor (c, c2))
-                {
-                    /* We found one, look no further */
-                    return TRUE;
-                }
+                /* We found one, look no further */
+                found = TRUE;
+                break;
             }
         }
+        g_slist_free (candidates);
+
+        return found;
     }
     else if (clientIsTransientOrModal (c))
     {
@@ -239,8 +395,9 @@ gboolean
 clientTransientOrModalHasAncestor (Client * c, guint ws)
 {
     Client *c2;
-    GList *list;
+    GSList *candidates, *list;
     ScreenInfo *screen_info;
+    gboolean found;
 
     g_return_val_if_fail (c != NULL, FALSE);
 
@@ -252,7 +409,9 @@ clientTransientOrModalHasAncestor (Client * c, guint ws)
     }
 
     screen_info = c->screen_info;
-    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+    found = FALSE;
+    candidates = clientListParentCandidates (c);
+    for (list = candidates; list; list = g_slist_next (list))
     {
         c2 = (Client *) list->data;
         if ((c2 != c)
@@ -263,23 +422,46 @@ clientTransientOrModalHasAncestor (Client * c, guint ws)
             && (((ws == screen_info->current_ws) && FLAG_TEST (c2->xfwm_flags, XFWM_FLAG_VISIBLE))
                 || !FLAG_TEST (c2->flags, CLIENT_FLAG_ICONIFIED)))
         {
-            return TRUE;
+            found = TRUE;
+            break;
         }
     }
-    return FALSE;
+    g_slist_free (candidates);
 
+    return found;
 }
 
 Client *
 clientGetModalFor (Client * c)
 {
     ScreenInfo *screen_info;
-    Client *c2;
+    Client *c2, *modal;
+    GSList *candidates, *list1;
     GList *list;
+    guint count;
 
     g_return_val_if_fail (c != NULL, NULL);
     TRACE ("entering clientGetModalFor");
 
+    /* Only walk the stack to pick the topmost one if there are several */
+    modal = NULL;
+    count = 0;
+    candidates = clientListChildCandidates (c);
+    for (list1 = candidates; list1; list1 = g_slist_next (list1))
+    {
+        c2 = (Client *) list1->data;
+        if ((c2 != c) && (c2 != modal) && clientIsModalFor (c2, c))
+        {
+            modal = c2;
+            count++;
+        }
+    }
+    g_slist_free (candidates);
+    if (count < 2)
+    {
+        return modal;
+    }
+
     screen_info = c->screen_info;
     for (list = g_list_last(screen_info->windows_stack); list; list = g_list_previous (list))
     {
@@ -327,86 +509,96 @@ clientGetTransientFor (Client * c)
     return latest_transient;
 }
 
-/* Build a GList of clients that have a transient relationship */
-GList *
-clientListTransient (Client * c)
+/*
+ * Build a GList of clients that have a transient relationship with c,
+ * starting with c, then following the windows stack. A client is
+ * listed when it is transient for a client listed before it.
+ */
+static GList *
+clientListFamily (Client * c, TransientTest test)
 {
     ScreenInfo *screen_info;
+    GHashTable *family;
+    GSList *pending, *candidates, *list;
+    GList *transients, *tail, *list1, *list2;
     Client *c2, *c3;
-    GList *transients;
-    GList *list1, *list2;
-
-    g_return_val_if_fail (c != NULL, NULL);
+    guint remaining;
 
-    transients = NULL;
     screen_info = c->screen_info;
-    transients = g_list_append (transients, c);
-    for (list1 = screen_info->windows_stack; list1; list1 = g_list_next (list1))
+
+    /* First gather all the descendants of c from the index... */
+    family = g_hash_table_new (g_direct_hash, g_direct_equal);
+    pending = g_slist_prepend (NULL, c);
+    while (pending)
     {
-        c2 = (Client *) list1->data;
-        if (c2 != c)
+        c2 = (Client *) pending->data;
+        pending = g_slist_delete_link (pending, pending);
+
+        candidates = clientListChildCandidates (c2);
+        for (list = candidates; list; list = g_slist_next (list))
         {
-            if (clientIsTransientFor (c2, c))
+            c3 = (Client *) list->data;
+            if ((c3 != c) && (c3 != c2)
+                && !g_hash_table_lookup (family, c3)
+                && test (c3, c2))
             {
-                transients = g_list_append (transients, c2);
+                g_hash_table_insert (family, c3, c3);
+                pending = g_slist_prepend (pending, c3);
             }
-            else
+        }
+        g_slist_free (candidates);
+    }
+
+    transients = g_list_prepend (NULL, c);
+    remaining = g_hash_table_size (family);
+    if (remaining == 0)
+    {
+        /* The usual case, no transient at all */
+        g_hash_table_destroy (family);
+        return transients;
+    }
+
+    /* ... then order them as they appear in the stack */
+    tail = transients;
+    for (list1 = screen_info->windows_stack; list1 && remaining; list1 = g_list_next (list1))
+    {
+        c2 = (Client *) list1->data;
+        if (!g_hash_table_lookup (family, c2))
+        {
+            continue;
+        }
+        remaining--;
+        for (list2 = transients; list2; list2 = g_list_next (list2))
+        {
+            c3 = (Client *) list2->data;
+            if ((c3 != c2) && test (c2, c3))
             {
-                for (list2 = transients; list2;
-                    list2 = g_list_next (list2))
-                {
-                    c3 = (Client *) list2->data;
-                    if ((c3 != c2) && clientIsTransientFor (c2, c3))
-                    {
-                        transients = g_list_append (transients, c2);
-                        break;
-                    }
-                }
+                tail = g_list_next (g_list_append (tail, c2));
+                break;
             }
         }
     }
+    g_hash_table_destroy (family);
+
     return transients;
 }
 
+/* Build a GList of clients that have a transient relationship */
+GList *
+clientListTransient (Client * c)
+{
+    g_return_val_if_fail (c != NULL, NULL);
+
+    return clientListFamily (c, clientIsTransientFor);
+}
+
 /* Build a GList of clients that have a transient or modal relationship */
 GList *
 clientListTransientOrModal (Client * c)
 {
-    ScreenInfo *screen_info;
-    Client *c2, *c3;
-    GList *transients;
-    GList *list1, *list2;
-
     g_return_val_if_fail (c != NULL, NULL);
 
-    screen_info = c->screen_info;
-    transients = NULL;
-    transients = g_list_append (transients, c);
-    for (list1 = screen_info->windows_stack; list1; list1 = g_list_next (list1))
-    {
-        c2 = (Client *) list1->data;
-        if (c2 != c)
-        {
-            if (clientIsTransientOrModalFor (c2, c))
-            {
-                transients = g_list_append (transients, c2);
-            }
-            else
-            {
-                for (list2 = transients; list2;
-                    list2 = g_list_next (list2))
-                {
-                    c3 = (Client *) list2->data;
-                    if ((c3 != c2) && clientIsTransientOrModalFor (c2, c3))
-                    {
-                        transients = g_list_append (transients, c2);
-                        break;
-                    }
-                }
-            }
-        }
-    }
-    return transients;
+    return clientListFamily (c, clientIsTransientOrModalFor);
 }
 
 /* Check if a window is not already listed in transients of a client.
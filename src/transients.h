@@ -31,6 +31,9 @@
 #include "client.h"
 
 Client                  *clientGetTransient                     (Client *);
+void                     clientTransientsAdd                    (Client *);
+void                     clientTransientsRemove                 (Client *);
+void                     clientTransientsUpdate                 (Client *);
 gboolean                 clientIsTransient                      (Client *);
 gboolean                 clientIsModal                          (Client *);
 gboolean                 clientIsTransientOrModal               (Client *);
@@ -45,6 +45,7 @@
 #include "focus.h"
 #include "stacking.h"
 #include "hints.h"
+#include "stats.h"
 
 static void
 workspaceGetPosition (ScreenInfo *screen_info, int n, int * row, int * col)
@@ -236,13 +237,149 @@ workspaceMove (ScreenInfo *screen_info, gint rowmod, gint colmod, Client * c, gu
     return (screen_info->current_ws != previous_ws);
 }
 
+static guint
+workspaceIndexKey (Client *c)
+{
+    return (FLAG_TEST (c->flags, CLIENT_FLAG_STICKY) ? ALL_WORKSPACES : c->win_workspace);
+}
+
+/*
+ * Each screen keeps its managed clients by workspace, with the sticky
+ * ones apart, plus the set of visible clients, so that switching
+ * workspaces only has to look at the windows it actually affects.
+ */
+void
+workspaceAddClient (Client *c)
+{
+    ScreenInfo *screen_info;
+
+    g_return_if_fail (c != NULL);
+    TRACE ("entering workspaceAddClient");
+
+    screen_info = c->screen_info;
+    c->indexed_workspace = workspaceIndexKey (c);
+    multimapInsert (screen_info->workspace_index, GUINT_TO_POINTER (c->indexed_workspace), c);
+    if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_VISIBLE))
+    {
+        g_hash_table_insert (screen_info->visible_index, c, c);
+    }
+}
+
+void
+workspaceRemoveClient (Client *c)
+{
+    ScreenInfo *screen_info;
+
+    g_return_if_fail (c != NULL);
+    TRACE ("entering workspaceRemoveClient");
+
+    screen_info = c->screen_info;
+    multimapRemove (screen_info->workspace_index, GUINT_TO_POINTER (c->indexed_workspace), c);
+    g_hash_table_remove (screen_info->visible_index, c);
+}
+
+/* To be called whenever the workspace, stickiness or visibility of c change */
+void
+workspaceUpdateClient (Client *c)
+{
+    ScreenInfo *screen_info;
+    guint key;
+
+    g_return_if_fail (c != NULL);
+
+    if (!FLAG_TEST (c->xfwm_flags, XFWM_FLAG_MANAGED))
+    {
+        /* Unmanaged clients get filed by workspaceAddClient() once managed */
+        return;
+    }
+
+    screen_info = c->screen_info;
+    key = workspaceIndexKey (c);
+    if (key != c->indexed_workspace)
+    {
+        multimapRemove (screen_info->workspace_index, GUINT_TO_POINTER (c->indexed_workspace), c);
+        c->indexed_workspace = key;
+        multimapInsert (screen_info->workspace_index, GUINT_TO_POINTER (c->indexed_workspace), c);
+    }
+    if (FLAG_TEST (c->xfwm_flags, XFWM_FLAG_VISIBLE))
+    {
+        g_hash_table_insert (screen_info->visible_index, c, c);
+    }
+    else
+    {
+        g_hash_table_remove (screen_info->visible_index, c);
+    }
+}
+
+static gint
+workspaceCompareStackPosition (gconstpointer a, gconstpointer b)
+{
+    const Client *c1 = (const Client *) a;
+    const Client *c2 = (const Client *) b;
+
+    if (c1->stack_position < c2->stack_position)
+    {
+        return -1;
+    }
+    return (c1->stack_position > c2->stack_position);
+}
+
+static void
+workspaceCollectVisible (gpointer key, gpointer value, gpointer user_data)
+{
+    GList **list = (GList **) user_data;
+
+    *list = g_list_prepend (*list, value);
+}
+
+/*
+ * List the clients on workspace ws and the sticky ones, in stacking
+ * order from bottom to top.
+ */
+static GList *
+workspaceListClients (ScreenInfo *screen_info, guint ws)
+{
+    GSList *entries;
+    GList *list;
+
+    list = NULL;
+    entries = multimapLookup (screen_info->workspace_index, GUINT_TO_POINTER (ws));
+    for (; entries; entries = g_slist_next (entries))
+    {
+        list = g_list_prepend (list, entries->data);
+    }
+    entries = multimapLookup (screen_info->workspace_index, GUINT_TO_POINTER (ALL_WORKSPACES));
+    for (; entries; entries = g_slist_next (entries))
+    {
+        list = g_list_prepend (list, entries->data);
+    }
+
+    return g_list_sort (list, workspaceCompareStackPosition);
+}
+
+/* Same for the visible clients */
+static GList *
+workspaceListVisible (ScreenInfo *screen_info, Client *extra)
+{
+    GList *list;
+
+    list = NULL;
+    g_hash_table_foreach (screen_info->visible_index, workspaceCollectVisible, &list);
+    if ((extra) && !g_hash_table_lookup (screen_info->visible_index, extra))
+    {
+        list = g_list_prepend (list, extra);
+    }
+
+    return g_list_sort (list, workspaceCompareStackPosition);
+}
+
 void
 workspaceSwitch (ScreenInfo *screen_info, gint new_ws, Client * c2, gboolean update_focus, guint32 timestamp)
 {
     DisplayInfo *display_info;
     Client *c, *new_focus;
     Client *previous;
-    GList *list;
+    GList *candidates, *list;
     Window dr, window;
     gint rx, ry, wx, wy;
     unsigned int mask;
@@ -302,8 +439,14 @@ workspaceSwitch (ScreenInfo *screen_info, gint new_ws, Client * c2, gboolean upd
         }
     }
 
+    /*
+     * The passes below only look at the clients of the new workspace,
+     * the sticky ones and the visible ones, taken from the workspace
+     * index.
+     */
     /* First pass: Show, from top to bottom */
-    for (list = g_list_last(screen_info->windows_stack); list; list = g_list_previous (list))
+    candidates = workspaceListClients (screen_info, new_ws);
+    for (list = g_list_last (candidates); list; list = g_list_previous (list))
     {
         c = (Client *) list->data;
         if (FLAG_TEST (c->flags, CLIENT_FLAG_STICKY))
@@ -321,9 +464,11 @@ workspaceSwitch (ScreenInfo *screen_info, gint new_ws, Client * c2, gboolean upd
             }
         }
     }
+    g_list_free (candidates);
 
     /* Second pass: Hide from bottom to top */
-    for (list = screen_info->windows_stack; list; list = g_list_next (list))
+    candidates = workspaceListVisible (screen_info, previous);
+    for (list = candidates; list; list = g_list_next (list))
     {
         c = (Client *) list->data;
 
@@ -343,9 +488,11 @@ workspaceSwitch (ScreenInfo *screen_info, gint new_ws, Client * c2, gboolean upd
             }
         }
     }
+    g_list_free (candidates);
 
     /* Third pass: Check for focus, from top to bottom */
-    for (list = g_list_last(screen_info->windows_stack); list; list = g_list_previous (list))
+    candidates = workspaceListClients (screen_info, new_ws);
+    for (list = g_list_last (candidates); list; list = g_list_previous (list))
     {
         c = (Client *) list->data;
 
@@ -366,11 +513,13 @@ workspaceSwitch (ScreenInfo *screen_info, gint new_ws, Client * c2, gboolean upd
             FLAG_UNSET (c->xfwm_flags, XFWM_FLAG_FOCUS);
         }
     }
+    g_list_free (candidates);
 
     setNetCurrentDesktop (display_info, screen_info->xroot, new_ws);
-    if (!(screen_info->params->click_to_focus))
+    if (!(screen_info->params->click_to_focus) && !(c2))
     {
-        if (!(c2) && (XQueryPointer (myScreenGetXDisplay (screen_info), screen_info->xroot, &dr, &window, &rx, &ry, &wx, &wy, &mask)))
+        statsCount (STATS_QUERY_POINTER);
+        if (XQueryPointer (myScreenGetXDisplay (screen_info), screen_info->xroot, &dr, &window, &rx, &ry, &wx, &wy, &mask))
         {
             c = clientAtPosition (screen_info, rx, ry, NULL);
             if (c)
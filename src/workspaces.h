@@ -53,6 +53,9 @@ void                    workspaceSetNames                       (ScreenInfo *,
 void                    workspaceSetCount                       (ScreenInfo *,
                                                                  guint);
 void                    workspaceUpdateArea                     (ScreenInfo *);
+void                    workspaceAddClient                      (Client *);
+void                    workspaceRemoveClient                   (Client *);
+void                    workspaceUpdateClient                   (Client *);
 
 void                    workspaceInsert                         (ScreenInfo *,
                                                                  guint);
@@ -24,6 +24,7 @@
 #include "config.h"
 #endif
 
+#include "misc.h"
 #include "xsync.h"
 
 #ifdef HAVE_XSYNC
@@ -170,10 +171,26 @@ clientXSyncTimeout (gpointer data)
         wc.width = c->width;
         wc.height = c->height;
         clientConfigure (c, &wc, CWX | CWY | CWWidth | CWHeight, NO_CFG_FLAG);
+        c->resize_time = getCurrentTimeUsec ();
+        c->resize_pending = FALSE;
     }
     return (FALSE);
 }
 
+static guint
+clientXSyncGetTimeout (Client * c)
+{
+    guint timeout;
+
+    /*
+     * Give clients known to be slow to redraw more time before
+     * considering they do not reply.
+     */
+    timeout = (guint) (4 * c->xsync_latency / 1000);
+
+    return CLAMP (timeout, CLIENT_XSYNC_TIMEOUT, 4 * CLIENT_XSYNC_TIMEOUT);
+}
+
 static void
 clientXSyncResetTimeout (Client * c)
 {
@@ -183,7 +200,7 @@ clientXSyncResetTimeout (Client * c)
 
     clientXSyncClearTimeout (c);
     c->xsync_timeout_id = g_timeout_add_full (G_PRIORITY_DEFAULT,
-                                              CLIENT_XSYNC_TIMEOUT,
+                                              clientXSyncGetTimeout (c),
                                               (GtkFunction) clientXSyncTimeout,
                                               (gpointer) c, NULL);
 }
@@ -205,9 +222,41 @@ clientXSyncRequest (Client * c)
     clientIncrementXSyncValue (c);
     sendXSyncRequest (display_info, c->window, c->xsync_value);
     clientXSyncResetTimeout (c);
+    c->xsync_request_time = getCurrentTimeUsec ();
     c->xsync_waiting = TRUE;
 }
 
+void
+clientXSyncUpdate (Client * c, XSyncValue value)
+{
+    gint64 latency;
+
+    g_return_if_fail (c != NULL);
+
+    TRACE ("entering clientXSyncUpdate");
+
+    clientXSyncClearTimeout (c);
+    c->xsync_waiting = FALSE;
+    c->xsync_value = value;
+
+    if (c->xsync_request_time)
+    {
+        /* Keep a running average of the time the client takes to reply */
+        latency = getCurrentTimeUsec () - c->xsync_request_time;
+        if (c->xsync_latency)
+        {
+            c->xsync_latency = (3 * c->xsync_latency + latency) / 4;
+        }
+        else
+        {
+            c->xsync_latency = latency;
+        }
+        c->xsync_request_time = 0;
+        TRACE ("client \"%s\" (0x%lx) replied in %li usec, average %li usec",
+               c->name, c->window, (long) latency, (long) c->xsync_latency);
+    }
+}
+
 gboolean
 clientXSyncEnable (Client * c)
 {
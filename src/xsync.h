@@ -56,6 +56,8 @@ gboolean                 clientCreateXSyncAlarm                 (Client *);
 void                     clientDestroyXSyncAlarm                (Client *);
 void                     clientXSyncClearTimeout                (Client *);
 void                     clientXSyncRequest                     (Client *);
+void                     clientXSyncUpdate                      (Client *,
+                                                                 XSyncValue);
 gboolean                 clientXSyncEnable                      (Client *);
 #endif /* HAVE_XSYNC */
 